@@ -373,7 +373,30 @@ static unsigned get_size(unsigned t)
 
 void gen_switch(unsigned n, unsigned type)
 {
-	switch(get_size(type)) {
+	/* The binary search ops read far less of the table even for small
+	   switches so use them whenever cc1 sorted it */
+	if (switch_flags & SWITCH_SEARCH) {
+		switch(type) {
+		case CCHAR:
+			byteop_direct(op_switchbc);
+			break;
+		case UCHAR:
+			byteop_direct(op_switchbuc);
+			break;
+		case CLONG:
+			byteop_direct(op_switchbl);
+			break;
+		case ULONG:
+			byteop_direct(op_switchbul);
+			break;
+		case CSHORT:
+			byteop_direct(op_switchb);
+			break;
+		default:
+			byteop_direct(op_switchbu);
+			break;
+		}
+	} else switch(get_size(type)) {
 	case 1:
 		byteop_direct(op_switchc);
 		break;
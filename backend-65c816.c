@@ -1349,7 +1349,11 @@ void gen_switch(unsigned n, unsigned type)
 	output("ldx #Sw%d", n);
 	/* FIXME: to work with output */
 	printf("\tjmp __switch");
-	helper_type(type, 0);
+	if ((switch_flags & SWITCH_SEARCH) && switch_cases >= SWITCH_BSEARCH_MIN) {
+		putchar('b');
+		helper_type(type, 1);
+	} else
+		helper_type(type, 0);
 	putchar('\n');
 	unreachable = 1;
 }
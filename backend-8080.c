@@ -557,7 +557,11 @@ void gen_switch(unsigned n, unsigned type)
 	opcode(OP_LXI, 0, R_DE, "lxi d,Sw%u", n);
 	/* Nothing is preserved over a switch */
 	printf("\tjmp __switch");
-	helper_type(type, 0);
+	if ((switch_flags & SWITCH_SEARCH) && switch_cases >= SWITCH_BSEARCH_MIN) {
+		putchar('b');
+		helper_type(type, 1);
+	} else
+		helper_type(type, 0);
 	putchar('\n');
 }
 
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
@@ -16,6 +17,7 @@
 #include "symtab.h"
 #include "compiler.h"
 #include "backend.h"
+#include "stats.h"
 
 int sym_fd = -1;
 
@@ -35,11 +37,60 @@ void error(const char *p)
 	exit(1);
 }
 
+#ifndef CONFIG_HOSTED
 static void xread(int fd, void *buf, int len)
 {
 	if (read(fd, buf, len) != len)
 		error("short read");
 }
+#endif
+
+/*
+ *	Simple block buffer read of the tree stream. Nodes, headers and
+ *	literal bytes are small so reading them one at a time costs a
+ *	system call for a handful of bytes.
+ */
+
+#define INBUF_SIZE	512
+
+static uint8_t inbuf[INBUF_SIZE];
+static uint8_t *inptr;
+static unsigned inlen;
+
+/* Read up to len bytes of the stream, return how many we got */
+static unsigned in_block(void *buf, unsigned len)
+{
+	register uint8_t *p = buf;
+	register unsigned n;
+	int r;
+
+	while (len) {
+		if (inlen == 0) {
+			r = read(0, inbuf, INBUF_SIZE);
+			if (r < 0)
+				error("read error");
+			if (r == 0)
+				break;
+			inptr = inbuf;
+			inlen = r;
+		}
+		n = inlen;
+		if (n > len)
+			n = len;
+		memcpy(p, inptr, n);
+		inptr += n;
+		inlen -= n;
+		p += n;
+		len -= n;
+	}
+	return p - (uint8_t *)buf;
+}
+
+static void in_read(void *buf, unsigned len)
+{
+	if (in_block(buf, len) != len)
+		error("short read");
+}
 
 /*
  *	Name symbol table.
@@ -49,10 +100,55 @@ static void xread(int fd, void *buf, int len)
  *	objects.
  */
 
+#ifdef CONFIG_HOSTED
+
+/*
+ *	On a hosted build we just keep the whole table in memory indexed by
+ *	the symbol number. The front end may still be adding names if we are
+ *	reading from a pipe, so when we see a name we don't have we read in
+ *	whatever has been added since the last time.
+ */
+
+static struct name *nametab;
+static unsigned long namebytes;
+static unsigned long namesize;
+
+static void load_names(unsigned n)
+{
+	int r;
+	while (n >= namebytes / sizeof(struct name)) {
+		if (namebytes == namesize) {
+			namesize = namesize ? 2 * namesize : 256 * sizeof(struct name);
+			nametab = realloc(nametab, namesize);
+			if (nametab == NULL)
+				error("out of memory");
+		}
+		if (lseek(sym_fd, 2 + namebytes, 0) < 0)
+			error("seeksym");
+		r = read(sym_fd, (uint8_t *)nametab + namebytes, namesize - namebytes);
+		if (r <= 0)
+			error("badsym");
+		namebytes += r;
+	}
+}
+
+char *namestr(register unsigned n)
+{
+	n &= 0x7FFF;
+	if (n >= namebytes / sizeof(struct name))
+		load_names(n);
+	return nametab[n].name;
+}
+
+static void init_name_cache(void)
+{
+}
+
+#else
+
 #define NCACHE_SIZE	32
 static struct name names[NCACHE_SIZE];
 static struct name *nhead;
-static unsigned max_name;
 
 char *namestr(register unsigned n)
 {
@@ -90,6 +186,8 @@ static void init_name_cache(void)
 	nhead = names;
 }
 
+#endif
+
 /*
  *	Expression tree nodes
  */
@@ -163,11 +261,10 @@ static void pop_area(void)
 	}
 }
 
-/* I/O buffering stuff can wait - as can switching to a block write method */
 static struct node *load_tree(void)
 {
 	register struct node *n = new_node();
-	xread(0, n, sizeof(struct node));
+	in_read(n, sizeof(struct node));
 
 	/* The values off disk are old pointers or NULL, that's good enough
 	   to use as a load flag */
@@ -348,10 +445,160 @@ static void dump_tree(register struct node *n, unsigned depth)
 }
 #endif
 
+#ifdef CONFIG_HOSTED
+
+/*
+ *	Driver statistics. When the driver is collecting them we also keep
+ *	a histogram of the runtime helpers we called and of how much inline
+ *	code each tree turned into, so we can see which helpers are worth
+ *	inlining or specializing on a target. We only have assembler text
+ *	so code size is counted in instructions, read back from our output.
+ */
+
+#define MAX_HELPERS	256
+#define TREE_BUCKETS	8
+
+static int stats_fd = -1;
+static unsigned long trees;
+static unsigned long helpers;
+static unsigned long instructions;
+static unsigned long tree_size[TREE_BUCKETS];
+
+struct helper_count {
+	char name[24];
+	unsigned long calls;
+};
+
+static struct helper_count helper_count[MAX_HELPERS];
+static unsigned helper_names;
+
+/* The helper being generated, with its type suffix */
+static char help_name[24];
+static unsigned help_len;
+
+static void helper_char(int c)
+{
+	putchar(c);
+	if (help_len < sizeof(help_name) - 1)
+		help_name[help_len++] = c;
+}
+
+static void count_helper(void)
+{
+	register struct helper_count *h = helper_count;
+	register struct helper_count *e = helper_count + helper_names;
+
+	help_name[help_len] = 0;
+	helpers++;
+	while (h < e) {
+		if (strcmp(h->name, help_name) == 0) {
+			h->calls++;
+			return;
+		}
+		h++;
+	}
+	if (helper_names == MAX_HELPERS)
+		return;
+	strcpy(h->name, help_name);
+	h->calls = 1;
+	helper_names++;
+}
+
+/* Where our output is, or -1 if it is not something we can read back */
+static off_t out_pos(void)
+{
+	fflush(stdout);
+	return lseek(1, 0L, SEEK_CUR);
+}
+
+/* Count the instructions written since start. Labels, directives and
+   comments don't count */
+static void count_tree(off_t start)
+{
+	off_t end = out_pos();
+	unsigned char buf[512];
+	unsigned long n = 0;
+	unsigned bucket = 0;
+	unsigned state = 0;	/* 0 line start, 1 after tab, 2 rest of line */
+	int i, r;
+
+	if (start < 0 || end < 0)
+		return;
+	while (start < end) {
+		r = pread(1, buf, end - start < 512 ? end - start : 512, start);
+		if (r <= 0)
+			return;
+		start += r;
+		for (i = 0; i < r; i++) {
+			if (buf[i] == '\n')
+				state = 0;
+			else if (state == 0)
+				state = buf[i] == '\t' ? 1 : 2;
+			else if (state == 1) {
+				if (buf[i] != '.' && buf[i] != ';')
+					n++;
+				state = 2;
+			}
+		}
+	}
+	instructions += n;
+	while (n && bucket < TREE_BUCKETS - 1) {
+		n >>= 1;
+		bucket++;
+	}
+	tree_size[bucket]++;
+}
+
+static int helper_cmp(const void *a, const void *b)
+{
+	const struct helper_count *x = a;
+	const struct helper_count *y = b;
+	if (x->calls != y->calls)
+		return x->calls < y->calls ? 1 : -1;
+	return strcmp(x->name, y->name);
+}
+
+/* One line per helper and per tree size so the reports add up across
+   files with a bit of awk */
+static void stats_report(void)
+{
+	unsigned i;
+
+	dprintf(stats_fd, "pass=cc2 trees=%lu helpers=%lu instructions=%lu\n",
+		trees, helpers, instructions);
+	qsort(helper_count, helper_names, sizeof(struct helper_count), helper_cmp);
+	for (i = 0; i < helper_names; i++)
+		dprintf(stats_fd, "pass=cc2 helper=__%s calls=%lu\n",
+			helper_count[i].name, helper_count[i].calls);
+	for (i = 0; i < TREE_BUCKETS; i++) {
+		if (tree_size[i] == 0)
+			continue;
+		if (i < 2)
+			dprintf(stats_fd, "pass=cc2 tree_insns=%u trees=%lu\n",
+				i, tree_size[i]);
+		else if (i == TREE_BUCKETS - 1)
+			dprintf(stats_fd, "pass=cc2 tree_insns=%u+ trees=%lu\n",
+				1 << (i - 1), tree_size[i]);
+		else
+			dprintf(stats_fd, "pass=cc2 tree_insns=%u-%u trees=%lu\n",
+				1 << (i - 1), (1 << i) - 1, tree_size[i]);
+	}
+}
+
+#else
+#define helper_char(c)	putchar(c)
+#endif
+
 static unsigned process_expression(void)
 {
 	register struct node *n = load_tree();
 	unsigned t;
+#ifdef CONFIG_HOSTED
+	off_t start = -1;
+	trees++;
+	if (stats_fd != -1)
+		start = out_pos();
+#endif
 #ifdef DEBUG
 	fprintf(stderr, ":load:\n");
 	dump_tree(n, 0);
@@ -363,6 +610,10 @@ static unsigned process_expression(void)
 	dump_tree(n, 0);
 #endif
 	gen_tree(n);
+#ifdef CONFIG_HOSTED
+	if (stats_fd != -1)
+		count_tree(start);
+#endif
 	t = n->type;
 	free_tree(n);
 	return t;
@@ -376,7 +627,7 @@ static unsigned compile_expression(void)
 	   expression is something like if (x = "eep"). Process up to and
 	   including our expression */
 	do {
-		xread(0, h, 2);
+		in_read(h, 2);
 		t = process_one_block(h);
 	} while (h[1] != '^');
 	return t;
@@ -392,6 +643,33 @@ static unsigned frame_len;
 static unsigned argframe_len;
 static unsigned func_ret_used;
 unsigned func_flags;
+unsigned switch_flags;		/* SWITCH_ flags for the switch being generated */
+struct switch_case switch_case[SWITCH_INFO];	/* and the case summary */
+unsigned switch_cases;
+
+/* Switch tables come in the reverse order of the switch headers. Track
+   the ones the target did not need as a bit stack so we can drop them.
+   If they nest too deep we just keep the outer tables */
+static unsigned long switch_notab;
+static unsigned skip_data;
+
+static void load_switch_info(void)
+{
+	uint8_t h[2];
+	struct node *n;
+	unsigned i;
+
+	for (i = 0; i < SWITCH_INFO; i++) {
+		in_read(h, 2);
+		if (h[0] != '%' || h[1] != '[')
+			error("sync");
+		n = load_tree();
+		switch_case[i].value = n->value;
+		switch_case[i].entry = n->val2;
+		switch_cases = n->snum;
+		free_node(n);
+	}
+}
 
 static void process_literal(unsigned id)
 {
@@ -403,7 +681,7 @@ static void process_literal(unsigned id)
 	/* A series of bytes terminated by a 0 marker. Internal
 	   zero is quoted, undo the quoting and turn it into data */
 	while (1) {
-		if (read(0, &c, 1) != 1)
+		if (in_block(&c, 1) != 1)
 			error("unexpected EOF");
 		if (c == 0) {
 			break;
@@ -424,7 +702,7 @@ static void process_header(void)
 	struct header h;
 	static char tbuf[16];
 
-	xread(0, &h, sizeof(struct header));
+	in_read(&h, sizeof(struct header));
 
 	switch (h.h_type) {
 	case H_EXPORT:
@@ -556,7 +834,12 @@ static void process_header(void)
 		break;
 	case H_SWITCH:
 		/* Generate the switch header, expression and table run */
+		switch_flags = h.h_data;
+		load_switch_info();
 		gen_switch(h.h_name, compile_expression());	/* need the type of it back */
+		switch_notab <<= 1;
+		if (switch_flags & SWITCH_NOTABLE)
+			switch_notab |= 1;
 		break;
 	case H_CASE:
 		gen_case_label(h.h_name, h.h_data);
@@ -568,11 +851,18 @@ static void process_header(void)
 		gen_label("_b", h.h_data);
 		break;
 	case H_SWITCHTAB:
+		skip_data = switch_notab & 1;
+		switch_notab >>= 1;
+		if (skip_data)
+			break;
 		push_area(A_LITERAL);
 		gen_switchdata(h.h_name, h.h_data);
 		break;
 	case H_SWITCHTAB | H_FOOTER:
-		pop_area();
+		if (skip_data)
+			skip_data = 0;
+		else
+			pop_area();
 		break;
 	case H_DATA:
 		push_area(A_DATA);
@@ -616,6 +906,10 @@ static void process_header(void)
 void process_data(void)
 {
 	register struct node *n = load_tree();
+	if (skip_data) {
+		free_node(n);
+		return;
+	}
 	switch (n->op) {
 	case T_PAD:
 		gen_space(n->value);
@@ -648,26 +942,26 @@ void helper_type(register unsigned t, unsigned s)
 	switch (t) {
 	case UCHAR:
 		if (s)
-			putchar('u');
+			helper_char('u');
 	case CCHAR:
-		putchar('c');
+		helper_char('c');
 		break;
 	case UINT:
 		if (s)
-			putchar('u');
+			helper_char('u');
 	case CSHORT:
 		break;
 	case ULONG:
 		if (s)
-			putchar('u');
+			helper_char('u');
 	case CLONG:
-		putchar('l');
+		helper_char('l');
 		break;
 	case FLOAT:
-		putchar('f');
+		helper_char('f');
 		break;
 	case DOUBLE:
-		putchar('d');
+		helper_char('d');
 		break;
 	default:
 		fflush(stdout);
@@ -689,6 +983,11 @@ void do_helper(register struct node *n, const char *h, unsigned t, unsigned s)
 		n->type = PTRTO;
 	gen_helpcall(n);
 	fputs(h, stdout);
+#ifdef CONFIG_HOSTED
+	help_len = 0;
+	while (*h && help_len < sizeof(help_name) - 1)
+		help_name[help_len++] = *h++;
+#endif
 	/* Bool and cast are special as they type convert. In the case of
 	   bool we care about the type below the bool, and the result is
 	   always integer. In the case of a cast we care about everything */
@@ -697,13 +996,17 @@ void do_helper(register struct node *n, const char *h, unsigned t, unsigned s)
 	else {
 		if (n->op == T_CAST) {
 			helper_type(n->right->type, 1);
-			putchar('_');
+			helper_char('_');
 		}
 		helper_type(t, s);
 	}
 	gen_helptail(n);
 	putchar('\n');
 	gen_helpclean(n);
+#ifdef CONFIG_HOSTED
+	if (stats_fd != -1)
+		count_helper();
+#endif
 }
 
 void helper(struct node *n, const char *h)
@@ -907,19 +1210,18 @@ void make_node(register struct node *n)
 }
 
 /*
- *	Load the symbol table from the front end
+ *	Open the symbol table from the front end. Names are read as needed
+ *	and we don't look at the length as the front end may still be
+ *	writing it if we are being fed down a pipe.
  */
 
 static void load_symbols(const char *path)
 {
-	uint8_t n[2];
 	sym_fd = open(path, O_RDONLY);
 	if (sym_fd == -1) {
 		perror(path);
 		exit(1);
 	}
-	xread(sym_fd, n, 2);
-	max_name = n[0] | (n[1] << 8);
 }
 
 static unsigned process_one_block(register uint8_t *h)
@@ -1069,13 +1371,21 @@ int main(int argc, char *argv[])
 	cpufeat = atol(argv[4]);
 	if (argv[5])
 		codeseg = argv[5];
+#ifdef CONFIG_HOSTED
+	stats_fd = stats_open();
+#endif
 	init_name_cache();
 	load_symbols(argv[1]);
 	init_nodes();
 
 	gen_start();
-	while (read(0, &h, 2) > 0) {
+	while (in_block(h, 2) > 0) {
 		process_one_block(h);
 	}
 	gen_end();
+#ifdef CONFIG_HOSTED
+	/* Report our counters if the driver is collecting statistics */
+	if (stats_fd != -1)
+		stats_report();
+#endif
 }
@@ -72,3 +72,20 @@ extern void make_node(struct node *n);
 #define MAX_SEG		3
 
 extern unsigned func_flags;
+extern unsigned switch_flags;
+
+/* The case summary from cc1, see SWITCH_INFO. Values are as written in
+   the table, so signed ones are masked to the size of the type */
+struct switch_case {
+	unsigned long value;
+	unsigned entry;
+};
+extern struct switch_case switch_case[SWITCH_INFO];
+extern unsigned switch_cases;
+
+/* The binary search switch helpers cost more to set up than the z80 ones
+   and only beat the linear helpers from about this many cases */
+#define SWITCH_BSEARCH_MIN	16
+
+/* Set in switch_flags by gen_switch if it did not use the table */
+#define SWITCH_NOTABLE	0x8000
@@ -140,7 +140,11 @@ void gen_jtrue(const char *tail, unsigned n)
 void gen_switch(unsigned n, unsigned type)
 {
 	printf("\tldx #Sw%u\n\t%s __switch", n, jmp_op);
-	helper_type(type, 0);
+	if ((switch_flags & SWITCH_SEARCH) && switch_cases >= SWITCH_BSEARCH_MIN) {
+		putchar('b');
+		helper_type(type, 1);
+	} else
+		helper_type(type, 0);
 	putchar('\n');
 }
 
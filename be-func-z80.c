@@ -265,13 +265,97 @@ void gen_helpclean(register struct node *n)
 	}
 }
 
+/*
+ *	A few cases are just compared in turn, and then we don't need the
+ *	table at all
+ */
+static void gen_switch_compare(unsigned n, unsigned size)
+{
+	struct switch_case *c = switch_case;
+	unsigned long last = 0;
+	unsigned i;
+
+	if (size == 1)
+		printf("\tld a,l\n");
+	for (i = 0; i < switch_cases; i++) {
+		if (size == 1)
+			printf("\tcp %lu\n", c->value & 0xFF);
+		else {
+			/* Keep the difference from the last value in HL */
+			if (c->value != last)
+				printf("\tld de,%lu\n\tadd hl,de\n", (last - c->value) & 0xFFFF);
+			printf("\tld a,h\n\tor l\n");
+			last = c->value;
+		}
+		printf("\tjp z,Sw%u_%u\n", n, c->entry);
+		c++;
+	}
+	printf("\tjp Sw%u_0\n", n);
+	switch_flags |= SWITCH_NOTABLE;
+}
+
+/*
+ *	A dense table can be indexed in line. Check the range and jump via
+ *	the label in the table entry
+ */
+static void gen_switch_index(unsigned n, unsigned size)
+{
+	unsigned long min = switch_case[0].value;
+	unsigned long mask = size == 1 ? 0xFF : 0xFFFF;
+	unsigned long range = ((switch_case[SWITCH_INFO - 1].value - min) & mask) + 1;
+
+	if (size == 1) {
+		printf("\tld a,l\n");
+		if (min & 0xFF)
+			printf("\tsub %lu\n", min & 0xFF);
+		if (range < 256)
+			printf("\tcp %lu\n\tjp nc,Sw%u_0\n", range, n);
+		/* 3 byte entries */
+		printf("\tld l,a\n\tld h,0\n\tld d,h\n\tld e,l\n");
+		printf("\tadd hl,hl\n\tadd hl,de\n\tld de,Sw%u+3\n", n);
+	} else {
+		if (min & 0xFFFF)
+			printf("\tld de,%lu\n\tadd hl,de\n", -min & 0xFFFF);
+		printf("\tld a,l\n\tsub %lu\n\tld a,h\n\tsbc a,%lu\n", range & 0xFF, range >> 8);
+		printf("\tjp nc,Sw%u_0\n", n);
+		/* 4 byte entries */
+		printf("\tadd hl,hl\n\tadd hl,hl\n\tld de,Sw%u+4\n", n);
+	}
+	printf("\tadd hl,de\n\tld a,(hl)\n\tinc hl\n\tld h,(hl)\n\tld l,a\n\tjp (hl)\n");
+}
+
+/*
+ *	The table is sorted so big ones can be binary searched (which needs
+ *	to know the signedness) and dense ones indexed directly. Small
+ *	switches and dense ones when not optimizing for size are done in
+ *	line. Long switches always use a helper.
+ */
 void gen_switch(unsigned n, unsigned type)
 {
+	unsigned size = get_size(type);
+
+	unreachable = 1;
+	if (size <= 2) {
+		if (switch_cases <= SWITCH_INFO && (!optsize || switch_cases < 2)) {
+			gen_switch_compare(n, size);
+			return;
+		}
+		if ((switch_flags & SWITCH_DENSE) && !optsize) {
+			gen_switch_index(n, size);
+			return;
+		}
+	}
 	printf("\tld de,Sw%u\n", n);
 	printf("\tjp __switch");
-	helper_type(type, 0);
+	if ((switch_flags & SWITCH_DENSE) && size <= 2) {
+		putchar('j');
+		helper_type(type, 0);
+	} else if (switch_flags & SWITCH_SEARCH) {
+		putchar('b');
+		helper_type(type, 1);
+	} else
+		helper_type(type, 0);
 	printf("\n");
-	unreachable = 1;
 }
 
 void gen_switchdata(unsigned n, unsigned size)
@@ -142,14 +142,16 @@ static void switch_statement(void)
 	unsigned oldswc = switch_count;
 	unsigned oldswtype = switch_type;
 	unsigned olddefault = switch_default;
-	unsigned long *swptr;
+	unsigned swptr;
+	unsigned long hrw;
 
 	switch_tag = next_tag++;
 	break_tag = next_tag++;
 	switch_count = 0;
 
 	next_token();
-	header(H_SWITCH, switch_tag, break_tag);
+	/* We know the table layout once we have seen the cases */
+	hrw = switch_start(switch_tag);
 	switch_type = bracketed_expression(0);
 
 	/* Only integral types */
@@ -166,7 +168,7 @@ static void switch_statement(void)
 	if (!switch_default)
 		header(H_DEFAULT, switch_tag, 0);
 
-	switch_done(switch_tag, swptr, switch_type);
+	switch_done(switch_tag, swptr, switch_type, hrw);
 
 	switch_type = oldswtype;
 	break_tag = oldbrk;
@@ -186,7 +188,7 @@ static void case_statement(void)
 	if (!is_constant(n))
 		notconst();
 	else
-		switch_add_node(n->value);
+		switch_add_node(n->value, switch_count + 1);
 	free_tree(n);
 	header(H_CASE, switch_tag, ++switch_count);
 	require(T_COLON);
@@ -377,8 +379,10 @@ void function_body(unsigned st, unsigned name, unsigned type)
 	register unsigned *p;
 	register unsigned n;
 
-	/* We are using both the ones allocated for locals and those registers */
-	func_flags = arg_flags & F_REGMASK;
+	/* We are using both the ones allocated for locals and those registers.
+	   F_NOADDR is cleared by write_tree if we see a local used any other
+	   way than as a simple variable */
+	func_flags = (arg_flags & F_REGMASK) | F_NOADDR;
 
 	/* Pass useful information flags to the backend */
 	func_type = func_return(type);
@@ -412,6 +416,9 @@ void function_body(unsigned st, unsigned name, unsigned type)
 
 	footer(H_FUNCTION, func_tag, name);
 
+	/* A volatile local has to be left alone even if used simply */
+	if (voltrack)
+		func_flags &= ~F_NOADDR;
 	rewrite_header(hrw, H_FRAME, frame_size(), func_flags);
 	check_labels();
 }
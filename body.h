@@ -7,6 +7,7 @@ extern unsigned arg_flags;
 #define F_VOIDRET		1
 #define F_VOID			2
 #define F_VARARG		4
+#define F_NOADDR		8	/* No local or argument address taken */
 
 /* Registers start at 1 and bit 8 to 15 */
 #define F_REG(n)		(1 << (n + 7))
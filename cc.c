@@ -45,6 +45,10 @@
 
 #define DEBUG
 
+#ifdef CC_ALL
+#define _GNU_SOURCE		/* memfd_create */
+#endif
+
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -55,6 +59,13 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#ifdef CONFIG_HOSTED
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+#ifdef CC_ALL
+#include <sys/mman.h>
+#endif
 
 /*
  *	For all non native compilers the directories moved and the rules
@@ -70,6 +81,7 @@
  *		cpp		(shared by all)
  *		cc0		(possibly shared may need work)
  *		cc1.cpuid
+ *		cc1b		(shared by all)
  *		cc2.cpuid
  *		copt		(shared by all)
  *		copt.cpuname
@@ -240,6 +252,11 @@ int c_files;
 int standalone;
 char *cpu = "8080";
 int mapfile;
+int jobs = 1;
+int dry_run;
+int pipe_passes;
+int stats;
+char *stat_path;
 
 #define OS_NONE		0
 #define OS_FUZIX	1
@@ -251,6 +268,8 @@ char *codeseg;
 char *symtab;
 
 #define MAXARG	512
+/* cc0, cc1, cc1b, cc2 and copt can all be running at once */
+#define MAXPASS	5
 
 int arginfd, argoutfd;
 const char *arglist[MAXARG];
@@ -474,11 +493,131 @@ static void resolve_libraries(void)
 	}
 }
 
-static void run_command(void)
+#ifdef CONFIG_HOSTED
+
+/*
+ *	Statistics (--stats). We time each pass we run and the passes add
+ *	their own counters. Both go into a scratch file as "pass=name k=v .."
+ *	lines, the passes finding it via FCC_STATS_FD. After each pass we
+ *	copy any new lines to the report with the source file added.
+ */
+
+static int stat_out = -1;	/* Where the report goes */
+static int stat_fd = -1;	/* Scratch file */
+static off_t stat_pos;
+static char *stat_src = "-";	/* Source file we are working on */
+
+struct started {
+	pid_t pid;
+	struct timeval start;
+};
+
+static struct started started[MAXPASS];
+
+static void stats_init(void)
 {
-	pid_t pid, p;
+	char buf[16];
+	FILE *f;
+
+	if (stat_out == -1) {
+		if (stat_path == NULL)
+			stat_out = 2;
+		else {
+			stat_out = open(stat_path, O_WRONLY | O_CREAT | O_APPEND, 0666);
+			if (stat_out == -1) {
+				perror(stat_path);
+				fatal();
+			}
+		}
+	}
+	if (stat_fd != -1)
+		close(stat_fd);
+	f = tmpfile();
+	if (f == NULL) {
+		perror("tmpfile");
+		fatal();
+	}
+	stat_fd = dup(fileno(f));
+	fclose(f);
+	/* Passes running at once all add to it */
+	fcntl(stat_fd, F_SETFL, O_APPEND);
+	stat_pos = 0;
+	snprintf(buf, 16, "%d", stat_fd);
+	setenv("FCC_STATS_FD", buf, 1);
+}
+
+static void stats_start(pid_t pid)
+{
+	struct started *s = started;
+	while (s->pid)
+		if (++s == started + MAXPASS) {
+			fprintf(stderr, "cc: too many passes to time.\n");
+			fatal();
+		}
+	s->pid = pid;
+	gettimeofday(&s->start, NULL);
+}
+
+static void stats_source(const char *p)
+{
+	if (stat_src[0] != '-')
+		free(stat_src);
+	stat_src = xstrdup((char *)p, 0);
+}
+
+static long usecs(struct timeval *t)
+{
+	return t->tv_sec * 1000000L + t->tv_usec;
+}
+
+/* Record the resources used by a pass. The name may be a path */
+static void stats_time(const char *name, struct timeval *start, struct rusage *ru)
+{
+	struct timeval now;
+	const char *p = strrchr(name, '/');
+	int len;
+
+	if (p)
+		name = p + 1;
+	/* cc1.z80 and friends are reported as cc1 */
+	p = strchr(name, '.');
+	len = p ? p - name : (int)strlen(name);
+	gettimeofday(&now, NULL);
+	dprintf(stat_fd, "pass=%.*s wall_us=%ld user_us=%ld sys_us=%ld maxrss_kb=%ld\n",
+		len, name, usecs(&now) - usecs(start), usecs(&ru->ru_utime),
+		usecs(&ru->ru_stime), ru->ru_maxrss);
+}
+
+/* Copy the new lines to the report */
+static void stats_flush(void)
+{
+	char buf[512];
+	char line[640];
+	int n, len = 0;
+	char *p;
+
+	while ((n = pread(stat_fd, buf + len, sizeof(buf) - 1 - len, stat_pos)) > 0) {
+		stat_pos += n;
+		len += n;
+		buf[len] = 0;
+		while ((p = strchr(buf, '\n')) != NULL) {
+			*p++ = 0;
+			n = snprintf(line, sizeof(line), "file=%s %s\n", stat_src, buf);
+			if (write(stat_out, line, n) != n)
+				perror("stats");
+			len -= p - buf;
+			memmove(buf, p, len + 1);
+		}
+	}
+}
+
+#endif
+
+/* Start the command we have built without waiting for it */
+static pid_t start_command(void)
+{
+	pid_t pid;
 	const char **ptr;
-	int status;
 
 	fflush(stdout);
 
@@ -489,6 +628,10 @@ static void run_command(void)
 		perror("fork");
 		fatal();
 	}
+#ifdef CONFIG_HOSTED
+	if (stats && pid)
+		stats_start(pid);
+#endif
 	if (pid == 0) {
 #ifdef DEBUG
 		if (print_passes) {
@@ -516,15 +659,44 @@ static void run_command(void)
 		close(arginfd);
 	if (argoutfd)
 		close(argoutfd);
+	return pid;
+}
+
+static void wait_command(pid_t pid, const char *name)
+{
+	pid_t p;
+	int status;
+#ifdef CONFIG_HOSTED
+	struct rusage ru;
+
+	while ((p = wait4(pid, &status, 0, &ru)) != pid) {
+		if (p == -1) {
+			perror("waitpid");
+			fatal();
+		}
+	}
+	if (stats) {
+		struct started *s = started;
+		while (s->pid != pid)
+			if (++s == started + MAXPASS) {
+				fprintf(stderr, "cc: %s was not timed.\n", name);
+				fatal();
+			}
+		s->pid = 0;
+		stats_time(name, &s->start, &ru);
+		stats_flush();
+	}
+#else
 	while ((p = waitpid(pid, &status, 0)) != pid) {
 		if (p == -1) {
 			perror("waitpid");
 			fatal();
 		}
 	}
+#endif
 	if (WIFSIGNALED(status)) {
 		/* Scream loudly if it exploded */
-		fprintf(stderr, "cc: %s failed with signal %d.\n", arglist[0],
+		fprintf(stderr, "cc: %s failed with signal %d.\n", name,
 			WTERMSIG(status));
 		fatal();
 	}
@@ -534,8 +706,18 @@ static void run_command(void)
 		fatal();
 }
 
+static void run_command(void)
+{
+	/* Just replaying a parallel job for the file names */
+	if (dry_run)
+		return;
+	wait_command(start_command(), arglist[0]);
+}
+
 static void redirect_in(const char *p)
 {
+	if (dry_run)
+		return;
 	arginfd = open(p, O_RDONLY);
 	if (arginfd == -1) {
 		perror(p);
@@ -549,6 +731,8 @@ static void redirect_in(const char *p)
 
 static void redirect_out(const char *p)
 {
+	if (dry_run)
+		return;
 	argoutfd = open(p, O_RDWR | O_CREAT | O_TRUNC, 0666);
 	if (argoutfd == -1) {
 		perror(p);
@@ -560,6 +744,26 @@ static void redirect_out(const char *p)
 #endif
 }
 
+/* Send the output of the command down a new pipe and return the
+   other end for the next command to read */
+static int redirect_pipe(void)
+{
+	int fd[2];
+	if (pipe(fd) == -1) {
+		perror("pipe");
+		fatal();
+	}
+	/* Only the two commands at each end may hold the pipe open */
+	fcntl(fd[0], F_SETFD, FD_CLOEXEC);
+	fcntl(fd[1], F_SETFD, FD_CLOEXEC);
+	argoutfd = fd[1];
+#ifdef DEBUG
+	if (print_passes)
+		printf(">|\n");
+#endif
+	return fd[0];
+}
+
 static void build_arglist(char *p)
 {
 	arginfd = -1;
@@ -580,12 +784,283 @@ void convert_s_to_o(char *path)
 	free(origpath);
 }
 
+/*
+ *	As convert_c_to_s but with the passes joined by pipes and all running
+ *	at once. This relies upon the hosted cc1 which doesn't seek its output
+ *	and upon cc0 writing names before the tokens that use them.
+ */
+static void convert_c_to_s_piped(char *path)
+{
+	char *t, *p = NULL;
+	char *out;
+	char **rm;
+	char optstr[2];
+	char featstr[16];
+	const char *name[MAXPASS];
+	pid_t pid[MAXPASS];
+	unsigned n = 0;
+	unsigned i;
+	int fd;
+
+	snprintf(featstr, 16, "%lu", features);
+
+	/* cc2 opens the symbol table as it starts so it must exist */
+	fd = open(symtab, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd == -1) {
+		perror(symtab);
+		fatal();
+	}
+	close(fd);
+
+	build_arglist(make_lib_name("cc0", ""));
+	add_argument(symtab);
+	t = xstrdup(path, 0);
+	redirect_in(pathmod(t, ".c", ".%", 0, 255));
+	fd = redirect_pipe();
+	name[n] = "cc0";
+	pid[n++] = start_command();
+
+	build_arglist(make_lib_name("cc1", cpudot));
+	add_argument(cpucode);
+	add_argument(featstr);
+	arginfd = fd;
+	fd = redirect_pipe();
+	name[n] = "cc1";
+	pid[n++] = start_command();
+
+	/* The last pass opens the output as it starts, so if this is an output
+	   we keep it goes with the temporaries until every pass has worked */
+	rm = rmptr;
+	out = pathmod(path, ".#", ".s", 2, 2);
+	if (rmptr == rm)
+		*rmptr++ = xstrdup(out, 0);
+	else
+		rm = NULL;
+
+	if (optimize != '0') {
+		build_arglist(make_lib_name("cc1b", ""));
+		arginfd = fd;
+		fd = redirect_pipe();
+		name[n] = "cc1b";
+		pid[n++] = start_command();
+	}
+
+	build_arglist(make_lib_name("cc2", cpudot));
+	add_argument(symtab);
+	add_argument(cpucode);
+	optstr[0] = optimize;
+	optstr[1] = '\0';
+	add_argument(optstr);
+	add_argument(featstr);
+	if (codeseg)
+		add_argument(codeseg);
+	arginfd = fd;
+	if (optimize == '0')
+		redirect_out(out);
+	else
+		fd = redirect_pipe();
+	name[n] = "cc2";
+	pid[n++] = start_command();
+
+	if (optimize != '0') {
+		p = xstrdup(make_lib_name("copt", ""), 0);
+		build_arglist(p);
+		add_argument(make_lib_name("rules.", cpuset));
+		arginfd = fd;
+		redirect_out(out);
+		name[n] = "copt";
+		pid[n++] = start_command();
+	}
+	for (i = 0; i < n; i++)
+		wait_command(pid[i], name[i]);
+	if (rm) {
+		free(*rm);
+		rmptr = rm;
+	}
+	free(t);
+	free(p);
+}
+
+#ifdef CC_ALL
+
+/*
+ *	Single process build. The passes for our CPU are linked in and called
+ *	directly with the intermediate files kept in memory. Each pass keeps
+ *	its state in globals and expects to start from fresh, so we still
+ *	fork once per file, but nothing is executed and only the .% input
+ *	and .s output touch the disk.
+ */
+
+extern int cc0_main(int argc, char *argv[]);
+extern int cc1_main(int argc, char *argv[]);
+extern int cc1b_main(int argc, char *argv[]);
+extern int cc2_main(int argc, char *argv[]);
+extern int copt_main(int argc, char *argv[]);
+
+static int mem_file(void)
+{
+	int fd = memfd_create("cc", 0);
+	if (fd == -1) {
+		perror("memfd_create");
+		exit(1);
+	}
+	return fd;
+}
+
+/* The output is only created once the passes before it worked */
+static int open_output(const char *p)
+{
+	int fd = open(p, O_RDWR | O_CREAT | O_TRUNC, 0666);
+	if (fd == -1) {
+		perror(p);
+		exit(1);
+	}
+	return fd;
+}
+
+/* Run a pass from the start of in to out. Passes that fail exit */
+static void run_pass(int (*pass)(int, char **), const char **argv, int in, int out)
+{
+	int argc = 0;
+
+	fflush(stdout);
+#ifdef DEBUG
+	if (print_passes) {
+		printf("[");
+		while(argv[argc])
+			printf("%s ", argv[argc++]);
+		printf("]\n");
+		fflush(stdout);
+	}
+#endif
+	argc = 0;
+	while(argv[argc])
+		argc++;
+	if (lseek(in, 0L, SEEK_SET) < 0) {
+		perror("lseek");
+		exit(1);
+	}
+	dup2(in, 0);
+	dup2(out, 1);
+	clearerr(stdin);
+	if (stats) {
+		struct timeval start;
+		struct rusage ru0, ru;
+		gettimeofday(&start, NULL);
+		getrusage(RUSAGE_SELF, &ru0);
+		if (pass(argc, (char **)argv))
+			exit(1);
+		fflush(stdout);
+		getrusage(RUSAGE_SELF, &ru);
+		/* Peak memory is for the whole process so far */
+		timersub(&ru.ru_utime, &ru0.ru_utime, &ru.ru_utime);
+		timersub(&ru.ru_stime, &ru0.ru_stime, &ru.ru_stime);
+		stats_time(argv[0], &start, &ru);
+		return;
+	}
+	if (pass(argc, (char **)argv))
+		exit(1);
+	fflush(stdout);
+}
+
+static void convert_c_to_s_inproc(char *path)
+{
+	char *t, *s;
+	char optstr[2];
+	char featstr[16];
+	char symname[32];
+	const char *argv[7];
+	int in, sym, tok, tree, opt, as;
+	pid_t pid;
+
+	snprintf(featstr, 16, "%lu", features);
+	optstr[0] = optimize;
+	optstr[1] = '\0';
+
+	t = xstrdup(path, 0);
+	pathmod(t, ".c", ".%", 0, 255);
+	s = pathmod(path, ".#", ".s", 2, 2);
+
+	fflush(stdout);
+	pid = fork();
+	if (pid == -1) {
+		perror("fork");
+		fatal();
+	}
+	if (stats && pid)
+		stats_start(pid);
+	if (pid == 0) {
+		in = open(t, O_RDONLY);
+		if (in == -1) {
+			perror(t);
+			exit(1);
+		}
+		/* cc0 and cc2 want a name for the symbol table */
+		sym = mem_file();
+		snprintf(symname, 32, "/proc/self/fd/%d", sym);
+
+		tok = mem_file();
+		argv[0] = "cc0";
+		argv[1] = symname;
+		argv[2] = NULL;
+		run_pass(cc0_main, argv, in, tok);
+
+		tree = mem_file();
+		argv[0] = "cc1";
+		argv[1] = cpucode;
+		argv[2] = featstr;
+		argv[3] = NULL;
+		run_pass(cc1_main, argv, tok, tree);
+
+		if (optimize != '0') {
+			opt = mem_file();
+			argv[0] = "cc1b";
+			argv[1] = NULL;
+			run_pass(cc1b_main, argv, tree, opt);
+			tree = opt;
+		}
+
+		as = optimize == '0' ? open_output(s) : mem_file();
+		argv[0] = "cc2";
+		argv[1] = symname;
+		argv[2] = cpucode;
+		argv[3] = optstr;
+		argv[4] = featstr;
+		argv[5] = codeseg;
+		argv[6] = NULL;
+		run_pass(cc2_main, argv, tree, as);
+
+		if (optimize != '0') {
+			argv[0] = "copt";
+			argv[1] = make_lib_name("rules.", cpuset);
+			argv[2] = NULL;
+			run_pass(copt_main, argv, as, open_output(s));
+		}
+		exit(0);
+	}
+	wait_command(pid, "cc-all");
+	free(t);
+}
+
+#endif
+
 void convert_c_to_s(char *path)
 {
 	char *tmp, *t, *p;
 	char optstr[2];
 	char featstr[16];
 
+#ifdef CC_ALL
+	if (!dry_run && strcmp(cpudot, CC_ALL) == 0) {
+		convert_c_to_s_inproc(path);
+		return;
+	}
+#endif
+	if (pipe_passes && !native && !dry_run) {
+		convert_c_to_s_piped(path);
+		return;
+	}
+
 	snprintf(featstr, 16, "%lu", features);
 
 	build_arglist(make_lib_name("cc0", ""));
@@ -608,6 +1083,15 @@ void convert_c_to_s(char *path)
 	redirect_out(tmp);
 	run_command();
 
+	/* The tree optimizer sits between cc1 and cc2 */
+	if (optimize != '0') {
+		build_arglist(make_lib_name("cc1b", ""));
+		redirect_in(tmp);
+		tmp = pathmod(path, ".#", ".!", 0, 255);
+		redirect_out(tmp);
+		run_command();
+	}
+
 	build_arglist(make_lib_name("cc2", cpudot));
 	add_argument(symtab);
 	add_argument(cpucode);
@@ -680,6 +1164,10 @@ void link_phase(void)
 	/* Set the target as a.out if there is no target */
 	if (target==NULL)
 		target= "a.out";
+#ifdef CONFIG_HOSTED
+	if (stats)
+		stats_source(target);
+#endif
 
 	build_arglist(p);
 	switch (targetos) {
@@ -764,6 +1252,10 @@ void link_phase(void)
 
 void sequence(struct obj *i)
 {
+#ifdef CONFIG_HOSTED
+	if (stats && !dry_run)
+		stats_source(i->name);
+#endif
 /*	printf("Last Phase %d\n", last_phase); */
 /*	printf("1:Processing %s %d\n", i->name, i->type); */
 	if (i->type == TYPE_S) {
@@ -794,10 +1286,129 @@ void sequence(struct obj *i)
 	}
 }
 
+/*
+ *	Parallel builds. Each file that needs work gets its own child which
+ *	runs the whole sequence with a private symbol table file and its
+ *	messages captured. The messages are reported in command line order
+ *	and every file is built even if an earlier one fails, so the result
+ *	does not depend on timing. Once a file is done the parent replays
+ *	the sequence without running anything to pick up the new names.
+ */
+
+struct job {
+	struct obj *obj;
+	pid_t pid;
+	FILE *log;
+	int status;
+};
+
+static void job_start(struct job *j)
+{
+	fflush(stdout);
+	fflush(stderr);
+	j->log = tmpfile();
+	if (j->log == NULL) {
+		perror("tmpfile");
+		fatal();
+	}
+	j->pid = fork();
+	if (j->pid == -1) {
+		perror("fork");
+		fatal();
+	}
+	if (j->pid == 0) {
+		dup2(fileno(j->log), 1);
+		dup2(fileno(j->log), 2);
+		symtab = xstrdup(".symtmp", 6);
+		snprintf(symtab + 7, 6, "%x", getpid());
+#ifdef CONFIG_HOSTED
+		/* Our own scratch file so we know the lines are ours */
+		if (stats)
+			stats_init();
+#endif
+		sequence(j->obj);
+		remove_temporaries();
+		if (keep_temp < 2)
+			unlink(symtab);
+		exit(0);
+	}
+}
+
+/* Report a finished job and catch the parent up with it */
+static void job_finish(struct job *j)
+{
+	int c;
+	rewind(j->log);
+	while ((c = getc(j->log)) != EOF)
+		putc(c, stderr);
+	fclose(j->log);
+	if (WIFSIGNALED(j->status))
+		fprintf(stderr, "cc: compiling %s failed with signal %d.\n",
+			j->obj->name, WTERMSIG(j->status));
+	if (j->status)
+		return;
+	dry_run = 1;
+	sequence(j->obj);
+	dry_run = 0;
+	remove_temporaries();
+}
+
+static void parallel_loop(void)
+{
+	struct obj *i;
+	struct job *jobtab, *j;
+	unsigned n = 0;
+	unsigned next = 0, done = 0, running = 0;
+	int failed = 0;
+	pid_t pid;
+	int status;
+
+	for (i = objlist.head; i; i = i->next)
+		n++;
+	jobtab = calloc(n, sizeof(struct job));
+	if (jobtab == NULL)
+		memory();
+	for (i = objlist.head, j = jobtab; i; i = i->next, j++) {
+		j->obj = i;
+		j->pid = -1;
+	}
+	while (done < n) {
+		/* Start as many jobs as we are allowed */
+		while (next < n && running < jobs) {
+			job_start(jobtab + next++);
+			running++;
+		}
+		pid = wait(&status);
+		if (pid == -1) {
+			perror("wait");
+			fatal();
+		}
+		for (j = jobtab; j < jobtab + next; j++) {
+			if (j->pid == pid) {
+				j->status = status;
+				j->pid = 0;
+				running--;
+				break;
+			}
+		}
+		/* Report everything that is complete, in order */
+		while (done < next && jobtab[done].pid == 0) {
+			if (jobtab[done].status)
+				failed = 1;
+			job_finish(jobtab + done++);
+		}
+	}
+	free(jobtab);
+	if (failed)
+		fatal();
+}
+
 void processing_loop(void)
 {
 	struct obj *i = objlist.head;
-	while (i) {
+	if (jobs > 1 && last_phase > 1)
+		parallel_loop();
+	else while (i) {
 		sequence(i);
 		remove_temporaries();
 		i = i->next;
@@ -926,6 +1537,17 @@ void extended_opt(const char *p)
 		crtname = "lib0.o";
 		return;
 	}
+#ifdef CONFIG_HOSTED
+	if (strcmp(p, "stats") == 0) {
+		stats = 1;
+		return;
+	}
+	if (strncmp(p, "stats=", 6) == 0) {
+		stats = 1;
+		stat_path = (char *)p + 6;
+		return;
+	}
+#endif
 	usage();
 }
 
@@ -995,6 +1617,21 @@ int main(int argc, char *argv[]) {
 		case 'D':
 			p = add_macro(p);
 			break;
+		case 'j':
+			if ((*p)[2])
+				jobs = atoi(*p + 2);
+			else if (p[1])
+				jobs = atoi(*++p);
+			if (jobs < 1) {
+				fprintf(stderr, "cc: bad job count.\n");
+				fatal();
+			}
+			break;
+		case 'p':
+			if (strcmp(*p, "-pipe"))
+				usage();
+			pipe_passes = 1;
+			break;
 		case 'i':
 /*                    split_id();*/
 			uniopt(*p);
@@ -1092,6 +1729,12 @@ int main(int argc, char *argv[]) {
 
 	symtab = xstrdup(".symtmp", 6);
 	snprintf(symtab + 7, 6, "%x", getpid());
+#ifdef CONFIG_HOSTED
+	if (stats)
+		stats_init();
+	else	/* A stray setting must not send the passes' counters anywhere */
+		unsetenv("FCC_STATS_FD");
+#endif
 	processing_loop();
 	unused_files();
 	if (keep_temp < 2)
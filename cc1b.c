@@ -0,0 +1,1423 @@
+/*
+ *	cc1b is an optional pass between cc1 and cc2 that works on the trees
+ *	cc1 produced and writes the same header/tree stream back out so any
+ *	cc2 can follow it.
+ *
+ *	Right now it does common subexpression elimination within a single
+ *	statement. If a pure subtree that is costly to work out, such as the
+ *	p->next part of p->next->a = p->next->b, occurs more than once then
+ *	it is worked out once into a new local and the uses load that.
+ *
+ *	In for loops it keeps addresses such as &a[i] that step with the
+ *	loop counter in locals of their own, so they are moved on by the step
+ *	rather than worked out with a multiply each time round.
+ *
+ *	It also removes stores to locals whose value is never used, either
+ *	because nothing reads the local at all or because in straight line
+ *	code it is stored again, or the function returns, before any read.
+ *	This is only done when cc1 tells us via F_NOADDR that no local has
+ *	its address taken, so nothing but the trees themselves can see them.
+ *
+ *	A function is held in memory until it ends so that the frame size
+ *	given by H_FRAME can be grown to make room for the new locals, and
+ *	so that the loops and stores can be checked against all of it. One
+ *	that is too big for that is passed through as it stands.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "compiler.h"
+#include "stats.h"
+
+/* Smallest subtree weight worth keeping in a local */
+#define CSE_WEIGHT	3
+/* Most locals we add per statement */
+#define CSE_MAX		4
+/* Most subtrees we consider per statement */
+#define CSE_NODES	64
+/* Largest function we hold in memory to work on */
+#define FUNC_MAX	0x40000UL
+
+static const char *argv0;
+
+void error(const char *p)
+{
+	fprintf(stderr, "%s: error: %s\n", argv0, p);
+	exit(1);
+}
+
+/*
+ *	Input. Block buffered as with cc2
+ */
+
+#define INBUF_SIZE	512
+
+static uint8_t inbuf[INBUF_SIZE];
+static uint8_t *inptr;
+static unsigned inlen;
+static uint8_t *memptr;		/* Reading a function back from memory */
+
+static unsigned in_block(void *buf, unsigned len)
+{
+	register uint8_t *p = buf;
+	register unsigned n;
+	int r;
+
+	if (memptr) {
+		memcpy(buf, memptr, len);
+		memptr += len;
+		return len;
+	}
+	while (len) {
+		if (inlen == 0) {
+			r = read(0, inbuf, INBUF_SIZE);
+			if (r < 0)
+				error("read error");
+			if (r == 0)
+				break;
+			inptr = inbuf;
+			inlen = r;
+		}
+		n = inlen;
+		if (n > len)
+			n = len;
+		memcpy(p, inptr, n);
+		inptr += n;
+		inlen -= n;
+		p += n;
+		len -= n;
+	}
+	return p - (uint8_t *)buf;
+}
+
+static void in_read(void *buf, unsigned len)
+{
+	if (in_block(buf, len) != len)
+		error("short read");
+}
+
+/*
+ *	Output. Everything goes into a buffer which is written out between
+ *	functions, so while we are in a function it holds all of it.
+ */
+
+static uint8_t *outbuf;
+static unsigned long outlen;
+static unsigned long outsize;
+static unsigned infunc;
+static unsigned long func_pos;	/* Where the function starts in outbuf */
+static unsigned passthru;	/* Function is being copied through as it is */
+static unsigned no_room;	/* Out of memory rewriting the function */
+
+static void put_flush(void)
+{
+	if (outlen && write(1, outbuf, outlen) != outlen)
+		error("write error");
+	outlen = 0;
+}
+
+/* Give up on the function. What we have so far goes out as it is and
+   the rest is written as it arrives */
+static void pass_through(void)
+{
+	put_flush();
+	infunc = 0;
+	passthru = 1;
+}
+
+static void put_block(const void *p, unsigned len)
+{
+	uint8_t *b;
+	unsigned long size = outsize;
+
+	/* Dropped, walk_function will put the old copy back */
+	if (no_room)
+		return;
+	if (infunc && memptr == NULL && outlen + len - func_pos > FUNC_MAX)
+		pass_through();
+	if (outlen + len > size) {
+		while (outlen + len > size)
+			size = size ? 2 * size : 4096;
+		b = realloc(outbuf, size);
+		if (b == NULL) {
+			if (memptr) {
+				no_room = 1;
+				return;
+			}
+			if (!infunc)
+				error("out of memory");
+			pass_through();
+			if (len > outsize)
+				error("out of memory");
+		} else {
+			outbuf = b;
+			outsize = size;
+		}
+	}
+	memcpy(outbuf + outlen, p, len);
+	outlen += len;
+}
+
+/*
+ *	Nodes
+ */
+
+static struct node *nodes;
+
+struct node *new_node(void)
+{
+	register struct node *n;
+	if (nodes == NULL)
+		init_nodes();
+	n = nodes;
+	nodes = n->right;
+	n->left = n->right = NULL;
+	n->value = 0;
+	n->flags = 0;
+	n->snum = 0;
+	n->val2 = 0;
+	return n;
+}
+
+void free_node(register struct node *n)
+{
+	n->right = nodes;
+	nodes = n;
+}
+
+/* Add another block of nodes to the free list */
+void init_nodes(void)
+{
+	register unsigned i;
+	register struct node *n = malloc(NUM_NODES * sizeof(struct node));
+	if (n == NULL)
+		error("out of memory");
+	for (i = 0; i < NUM_NODES; i++)
+		free_node(n++);
+}
+
+void free_tree(register struct node *n)
+{
+	if (n->left)
+		free_tree(n->left);
+	if (n->right)
+		free_tree(n->right);
+	free_node(n);
+}
+
+static struct node *load_tree(void)
+{
+	register struct node *n = new_node();
+	in_read(n, sizeof(struct node));
+	/* Old pointers or NULL, used as a flag */
+	if (n->left)
+		n->left = load_tree();
+	if (n->right)
+		n->right = load_tree();
+	return n;
+}
+
+/* Write a tree in the order cc1 does and free it */
+static void write_subtree(register struct node *n)
+{
+	put_block(n, sizeof(struct node));
+	if (n->left)
+		write_subtree(n->left);
+	if (n->right)
+		write_subtree(n->right);
+	free_node(n);
+}
+
+static struct node *copy_tree(register struct node *n)
+{
+	register struct node *c = new_node();
+	memcpy(c, n, sizeof(struct node));
+	if (n->left)
+		c->left = copy_tree(n->left);
+	if (n->right)
+		c->right = copy_tree(n->right);
+	return c;
+}
+
+/*
+ *	Function state
+ */
+
+static unsigned in_return;
+static unsigned long frame_pos;	/* Where the H_FRAME header is in outbuf */
+static unsigned frame_len;
+static unsigned frame_flags;
+static unsigned temp_max;	/* Most locals added by one statement */
+static unsigned lsr_slots;	/* Locals added for loops, which go first */
+static unsigned ntrees;		/* Statement trees in the function */
+
+#ifdef CONFIG_HOSTED
+static unsigned long trees;	/* For the driver statistics */
+static unsigned long cse_count;
+static unsigned long dse_count;
+static unsigned long lsr_count;
+#endif
+
+/* Our locals go after those cc1 allocated, word aligned for everyone */
+static unsigned temp_offset(unsigned slot)
+{
+	return ((frame_len + 1) & ~1) + 2 * slot;
+}
+
+/*
+ *	Common subexpressions
+ */
+
+/* Something that has a side effect or might do */
+static unsigned impure(register struct node *n)
+{
+	if (n->flags & SIDEEFFECT)
+		return 1;
+	if (n->op == T_FUNCCALL)
+		return 1;
+	if (n->left && impure(n->left))
+		return 1;
+	if (n->right && impure(n->right))
+		return 1;
+	return 0;
+}
+
+/* The top of a statement may have a side effect as it happens after
+   all the rest is worked out. For a call that includes the T_CLEANUP
+   around it. Anything below must be pure or moving work earlier could
+   change the result */
+static unsigned pure_below(register struct node *n)
+{
+	if (n->op == T_CLEANUP) {
+		if (n->right && impure(n->right))
+			return 0;
+		n = n->left;
+	}
+	if (n->left && impure(n->left))
+		return 0;
+	if (n->right && impure(n->right))
+		return 0;
+	return 1;
+}
+
+static unsigned is_var(register struct node *n)
+{
+	register unsigned op = n->op;
+	return op == T_LOCAL || op == T_ARGUMENT || op == T_NAME || op == T_LABEL;
+}
+
+/* Rough cost of working something out again compared with loading it
+   from our local. Loading a simple variable counts as one and anything
+   else from memory as two. Constants and registers are free */
+static unsigned weight(register struct node *n)
+{
+	register unsigned w = 1;
+
+	if (n->left == NULL && n->right == NULL)
+		return 0;
+	if (n->op == T_DEREF && n->left == NULL) {
+		if (n->right->op == T_REG)
+			return 0;
+		if (is_var(n->right))
+			return 1;
+		w = 2;
+	}
+	if (n->left)
+		w += weight(n->left);
+	if (n->right)
+		w += weight(n->right);
+	return w;
+}
+
+/* We only keep word sized things: addresses, pointers and ints. These
+   are two bytes on every target */
+static unsigned cse_type(register struct node *n)
+{
+	register unsigned t = n->type;
+	if (n->flags & LVAL)
+		return PTR(t) < 7;
+	if (PTR(t))
+		return 1;
+	return t == CSHORT || t == USHORT;
+}
+
+static unsigned same_tree(register struct node *a, register struct node *b)
+{
+	if (a->op != b->op || a->type != b->type || a->flags != b->flags)
+		return 0;
+	if (a->value != b->value || a->snum != b->snum)
+		return 0;
+	/* val2 is only meaningful for labels */
+	if (a->op == T_LABEL && a->val2 != b->val2)
+		return 0;
+	if ((a->left == NULL) != (b->left == NULL))
+		return 0;
+	if ((a->right == NULL) != (b->right == NULL))
+		return 0;
+	if (a->left && !same_tree(a->left, b->left))
+		return 0;
+	if (a->right && !same_tree(a->right, b->right))
+		return 0;
+	return 1;
+}
+
+/* The right hand side of && || and ?: may not be evaluated at all so
+   is left alone */
+static unsigned conditional(register struct node *n)
+{
+	register unsigned op = n->op;
+	return op == T_ANDAND || op == T_OROR || op == T_QUESTION;
+}
+
+static struct node *cand[CSE_NODES];
+static unsigned ncand;
+
+static void find_candidates(register struct node *n)
+{
+	if (ncand < CSE_NODES && cse_type(n) && weight(n) >= CSE_WEIGHT)
+		cand[ncand++] = n;
+	if (n->left)
+		find_candidates(n->left);
+	if (n->right && !conditional(n))
+		find_candidates(n->right);
+}
+
+/* Pick the subtree that saves the most work, if any */
+static struct node *best_candidate(struct node *n)
+{
+	struct node *best = NULL;
+	unsigned bestv = 0;
+	unsigned i, j, v;
+
+	ncand = 0;
+	if (n->left)
+		find_candidates(n->left);
+	if (n->right && !conditional(n))
+		find_candidates(n->right);
+
+	for (i = 0; i < ncand; i++) {
+		/* Seen it already */
+		for (j = 0; j < i; j++)
+			if (same_tree(cand[i], cand[j]))
+				break;
+		if (j < i)
+			continue;
+		v = 0;
+		for (j = i + 1; j < ncand; j++)
+			if (same_tree(cand[i], cand[j]))
+				v++;
+		v *= weight(cand[i]);
+		if (v > bestv) {
+			bestv = v;
+			best = cand[i];
+		}
+	}
+	return best;
+}
+
+/* One of our locals, holding the value of s */
+static struct node *temp_local(struct node *s, unsigned slot)
+{
+	register struct node *n = new_node();
+
+	n->op = T_LOCAL;
+	n->flags = LVAL;
+	n->value = temp_offset(slot);
+	/* If s is an lval then what we hold is its address */
+	n->type = s->type;
+	if (s->flags & LVAL)
+		n->type++;
+	return n;
+}
+
+/* A load of it to use in place of s */
+static struct node *temp_ref(struct node *s, unsigned slot)
+{
+	register struct node *n = new_node();
+
+	n->op = T_DEREF;
+	n->type = s->type;
+	n->flags = s->flags & LVAL;
+	n->right = temp_local(s, slot);
+	return n;
+}
+
+static struct node *replace_tree(register struct node *n, struct node *s, unsigned slot)
+{
+	if (same_tree(n, s)) {
+		free_tree(n);
+		return temp_ref(s, slot);
+	}
+	if (n->left)
+		n->left = replace_tree(n->left, s, slot);
+	if (n->right && !conditional(n))
+		n->right = replace_tree(n->right, s, slot);
+	return n;
+}
+
+/* Make local = s, where s is the work we are saving */
+static struct node *temp_assign(struct node *s, unsigned slot)
+{
+	register struct node *n = new_node();
+	n->op = T_EQ;
+	n->flags = SIDEEFFECT | NORETURN;
+	n->left = temp_local(s, slot);
+	n->right = s;
+	n->type = n->left->type;
+	/* If we are keeping an address it is no longer an lval */
+	if (s->flags & LVAL) {
+		s->flags &= ~LVAL;
+		s->type++;
+	}
+	return n;
+}
+
+static struct node *cse_tree(struct node *n)
+{
+	struct node *head = n;
+	struct node **link = &head;
+	struct node *s, *c;
+	unsigned slot;
+
+	if (!pure_below(n))
+		return n;
+	for (slot = 0; slot < CSE_MAX; slot++) {
+		s = best_candidate(n);
+		if (s == NULL)
+			break;
+		s = copy_tree(s);
+		n = replace_tree(n, s, lsr_slots + slot);
+		/* Work out the value first, then do the statement */
+		c = new_node();
+		c->op = T_COMMA;
+		c->type = n->type;
+		c->flags = n->flags & NORETURN;
+		c->left = temp_assign(s, lsr_slots + slot);
+		c->right = n;
+		*link = c;
+		link = &c->right;
+#ifdef CONFIG_HOSTED
+		cse_count++;
+#endif
+	}
+	if (slot > temp_max)
+		temp_max = slot;
+	return head;
+}
+
+/*
+ *	Stream processing
+ */
+
+static void process_tree(void)
+{
+	struct node *n = load_tree();
+#ifdef CONFIG_HOSTED
+	trees++;
+#endif
+	ntrees++;
+	put_block("%^", 2);
+	write_subtree(n);
+}
+
+static void process_data(void)
+{
+	struct node *n = load_tree();
+	put_block("%[", 2);
+	write_subtree(n);
+}
+
+/* Copy the bytes of a literal up to and including the end marker */
+static void process_literal(void)
+{
+	uint8_t c;
+	do {
+		in_read(&c, 1);
+		put_block(&c, 1);
+		/* Quoted byte */
+		if (c == 255) {
+			in_read(&c, 1);
+			put_block(&c, 1);
+		}
+	} while (c);
+}
+
+/*
+ *	Whole function passes. The function is held in outbuf from func_pos
+ *	when it ends, and we walk it record by record. Each statement tree is
+ *	passed to a handler which can give back a new tree or NULL to drop
+ *	it, and if we are rewriting the function is written out again with
+ *	the trees the handlers gave back. If there is not the memory to do
+ *	that the function is left as it was and no_room is set.
+ */
+
+static unsigned tree_num;	/* The tree we are on */
+static unsigned for_part;	/* Counts down the init, condition and step of a for */
+
+static void walk_function(void (*hfn)(struct header *),
+			  struct node *(*tfn)(struct node *), unsigned rewrite)
+{
+	unsigned long len = outlen - func_pos;
+	uint8_t *buf = outbuf + func_pos;
+	uint8_t *end;
+	struct header h;
+	struct node *n;
+	uint8_t type;
+
+	if (rewrite) {
+		buf = malloc(len);
+		if (buf == NULL) {
+			no_room = 1;
+			return;
+		}
+		memcpy(buf, outbuf + func_pos, len);
+		outlen = func_pos;
+	}
+	end = buf + len;
+	memptr = buf;
+	tree_num = 0;
+	for_part = 0;
+	while (memptr < end) {
+		type = memptr[1];
+		memptr += 2;
+		if (type == 'H') {
+			in_read(&h, sizeof(h));
+			if (rewrite) {
+				put_block("%H", 2);
+				put_block(&h, sizeof(h));
+			}
+			hfn(&h);
+			if (h.h_type == H_FOR)
+				for_part = 3;
+			if (h.h_type == H_STRING) {
+				if (rewrite)
+					process_literal();
+				else while (*memptr++)
+					if (memptr[-1] == 255)
+						memptr++;
+			}
+			continue;
+		}
+		n = load_tree();
+		if (type == '[') {
+			if (rewrite) {
+				put_block("%[", 2);
+				write_subtree(n);
+			} else
+				free_tree(n);
+			continue;
+		}
+		n = tfn(n);
+		if (n) {
+			if (rewrite) {
+				put_block("%^", 2);
+				write_subtree(n);
+			} else
+				free_tree(n);
+		}
+		tree_num++;
+		if (for_part)
+			for_part--;
+	}
+	memptr = NULL;
+	if (rewrite) {
+		/* outbuf has held all of it before so it still fits */
+		if (no_room) {
+			memcpy(outbuf + func_pos, buf, len);
+			outlen = func_pos + len;
+		}
+		free(buf);
+	}
+}
+
+static uint8_t *grow_bytes(uint8_t *p, unsigned *max, unsigned len)
+{
+	if (len <= *max)
+		return p;
+	*max = len;
+	p = realloc(p, len);
+	if (p == NULL)
+		error("out of memory");
+	return p;
+}
+
+/*
+ *	Dead stores
+ *
+ *	We walk the function marking statement trees that are stores to a
+ *	local we can remove, and repeat until nothing more is found as
+ *	dropping a store also drops the reads it made. Then the function is
+ *	written again without them.
+ */
+
+/* Part of the frame used by a node, and the store we are looking at */
+struct access {
+	unsigned op;
+	unsigned long lo;
+	unsigned long hi;
+	unsigned tree;
+};
+
+/* Stores waiting to see if they are used before being stored again */
+#define DSE_PENDING	16
+
+static struct access *reads;
+static unsigned nreads;
+static unsigned maxreads;
+static struct access *stores;
+static unsigned nstores;
+static unsigned maxstores;
+static struct access pending[DSE_PENDING];
+static unsigned npending;
+static uint8_t *dead;
+static unsigned maxdead;
+static unsigned dse_changed;
+
+static unsigned is_local(register struct node *n)
+{
+	return n->op == T_LOCAL || n->op == T_ARGUMENT;
+}
+
+/* Bytes used by the object types we handle, or 0 */
+static unsigned local_size(register unsigned t)
+{
+	if (PTR(t))
+		return 2;
+	switch(t & ~UNSIGNED) {
+	case CCHAR:
+		return 1;
+	case CSHORT:
+		return 2;
+	case CLONG:
+	case FLOAT:
+		return 4;
+	}
+	return 0;
+}
+
+static struct access *grow(struct access *a, unsigned *max)
+{
+	*max = *max ? 2 * *max : 32;
+	a = realloc(a, *max * sizeof(struct access));
+	if (a == NULL)
+		error("out of memory");
+	return a;
+}
+
+static void set_access(register struct access *a, register struct node *n, unsigned tree)
+{
+	unsigned size = local_size(n->type);
+	a->op = n->op;
+	a->lo = n->value;
+	/* If we don't know then assume it could be anything from here up */
+	a->hi = size ? n->value + size : ~0UL;
+	a->tree = tree;
+}
+
+static unsigned overlaps(register struct access *a, register struct access *b)
+{
+	return a->op == b->op && a->lo < b->hi && b->lo < a->hi;
+}
+
+static void mark_dead(unsigned tree)
+{
+	if (!dead[tree]) {
+		dead[tree] = 1;
+		dse_changed = 1;
+	}
+}
+
+/* Any pending store that overlaps a is no longer a candidate. If the
+   store covers it completely then it was never used */
+static void drop_pending(struct access *a, unsigned store)
+{
+	register struct access *p = pending;
+	register struct access *e = pending + npending;
+
+	while (p < e) {
+		if (overlaps(p, a)) {
+			if (store && a->lo <= p->lo && a->hi >= p->hi)
+				mark_dead(p->tree);
+			memcpy(p, --e, sizeof(struct access));
+		} else
+			p++;
+	}
+	npending = e - pending;
+}
+
+static void add_read(register struct node *n)
+{
+	if (nreads == maxreads)
+		reads = grow(reads, &maxreads);
+	set_access(reads + nreads, n, 0);
+	drop_pending(reads + nreads, 0);
+	nreads++;
+}
+
+static void find_reads(register struct node *n)
+{
+	if (is_local(n))
+		add_read(n);
+	if (n->left)
+		find_reads(n->left);
+	if (n->right)
+		find_reads(n->right);
+}
+
+/* A statement that is just a store to a local we can track */
+static unsigned local_store(register struct node *n)
+{
+	return (n->flags & NORETURN) && n->op == T_EQ && is_local(n->left) &&
+		local_size(n->left->type);
+}
+
+/* The function is left so anything not read yet never will be */
+static void end_pending(void)
+{
+	while (npending)
+		mark_dead(pending[--npending].tree);
+}
+
+static struct node *dse_scan(register struct node *n)
+{
+	register struct access *a;
+
+	if (!in_return && local_store(n)) {
+		/* Going anyway, but the right hand side may need to stay */
+		if (dead[tree_num]) {
+			if (impure(n->right))
+				find_reads(n->right);
+		} else {
+			find_reads(n->right);
+			if (nstores == maxstores)
+				stores = grow(stores, &maxstores);
+			a = stores + nstores++;
+			set_access(a, n->left, tree_num);
+			drop_pending(a, 1);
+			/* The parts of a for are not run in the order we see them */
+			if (!for_part && npending < DSE_PENDING)
+				memcpy(pending + npending++, a, sizeof(struct access));
+		}
+	} else
+		find_reads(n);
+	if (for_part)
+		npending = 0;
+	return n;
+}
+
+static void dse_header(struct header *h)
+{
+	switch(h->h_type) {
+	case H_RETURN:
+		in_return = 1;
+		break;
+	case H_RETURN | H_FOOTER:
+		in_return = 0;
+		/* Fall through */
+	case H_FUNCTION | H_FOOTER:
+		end_pending();
+		break;
+	default:
+		npending = 0;
+	}
+}
+
+/* Stores that nothing reads at all */
+static void dse_unread(void)
+{
+	register struct access *a = stores;
+	register struct access *e = stores + nstores;
+	register struct access *r;
+
+	while (a < e) {
+		for (r = reads; r < reads + nreads; r++)
+			if (overlaps(a, r))
+				break;
+		if (r == reads + nreads)
+			mark_dead(a->tree);
+		a++;
+	}
+}
+
+/* Drop the store, keeping the value if it has side effects */
+static struct node *dse_rewrite(register struct node *n)
+{
+	struct node *r;
+
+	if (!dead[tree_num])
+		return n;
+#ifdef CONFIG_HOSTED
+	dse_count++;
+#endif
+	r = n->right;
+	free_tree(n->left);
+	free_node(n);
+	if (impure(r)) {
+		r->flags |= NORETURN;
+		return r;
+	}
+	free_tree(r);
+	/* The parts of a for must all be there */
+	if (for_part) {
+		r = new_node();
+		r->op = T_NULL;
+		r->type = VOID;
+		return r;
+	}
+	return NULL;
+}
+
+static void dead_stores(void)
+{
+	unsigned i;
+
+	if (!(frame_flags & F_NOADDR))
+		return;
+	dead = grow_bytes(dead, &maxdead, ntrees);
+	memset(dead, 0, ntrees);
+	do {
+		dse_changed = 0;
+		nreads = 0;
+		nstores = 0;
+		npending = 0;
+		in_return = 0;
+		walk_function(dse_header, dse_scan, 0);
+		dse_unread();
+	} while (dse_changed);
+	for (i = 0; i < ntrees; i++)
+		if (dead[i])
+			break;
+	if (i < ntrees)
+		walk_function(dse_header, dse_rewrite, 1);
+}
+
+/*
+ *	Loops
+ *
+ *	In a for loop that steps a local int by a constant, an address such
+ *	as &a[i], which is a + i * sizeof(*a), can be kept in a local of its
+ *	own instead. It is worked out after the init and moved on by the
+ *	step, so each use is a load rather than a multiply and add.
+ *
+ *	This needs to know the loop counter and the base don't change other
+ *	than by the step, so any local whose address is taken anywhere in
+ *	the function is left alone.
+ */
+
+/* Most loops we look at in a function, and how deeply nested */
+#define LSR_LOOPS	16
+#define LSR_DEPTH	8
+/* Most addresses kept per loop */
+#define LSR_PTRS	4
+/* Most locals assigned in a loop we keep track of */
+#define LSR_WRITES	8
+/* Smallest saving each time round the loop worth a local */
+#define LSR_WEIGHT	3
+
+struct lsr_ptr {
+	struct node *pat;	/* The first use of it */
+	unsigned scale;
+	unsigned weight;	/* Saving each time round the loop */
+	unsigned slot;		/* Ours or 0 */
+};
+
+struct loop {
+	unsigned tag;
+	unsigned init;		/* Tree number of the init. The condition and
+				   step follow it */
+	unsigned end;		/* First tree after the loop */
+	unsigned ok;
+	struct node *cond;	/* Held until we know the counter */
+	struct access ivar;
+	unsigned long step;
+	unsigned down;
+	struct lsr_ptr ptr[LSR_PTRS];
+	unsigned nptr;
+	struct access write[LSR_WRITES];
+	unsigned nwrite;	/* LSR_WRITES + 1 if we ran out */
+};
+
+static struct loop loops[LSR_LOOPS];
+static unsigned nloops;
+static struct loop *open_loop[LSR_DEPTH];
+static unsigned loop_depth;
+static struct access *escapes;
+static unsigned nescapes;
+static unsigned maxescapes;
+
+static unsigned is_assign(register unsigned op)
+{
+	return op == T_EQ || op == T_PLUSPLUS || op == T_MINUSMINUS ||
+		op == T_PLUSEQ || op == T_MINUSEQ || op == T_STAREQ ||
+		op == T_SLASHEQ || op == T_PERCENTEQ || op == T_SHLEQ ||
+		op == T_SHREQ || op == T_ANDEQ || op == T_HATEQ || op == T_OREQ;
+}
+
+/* Locals used other than by loading or assigning them. All we need to
+   know is where they start as nothing else can be reached legally */
+static void find_escapes(register struct node *n, register struct node *p)
+{
+	if (is_local(n) && (p == NULL || (p->op != T_DEREF &&
+				(n != p->left || !is_assign(p->op))))) {
+		if (nescapes == maxescapes)
+			escapes = grow(escapes, &maxescapes);
+		set_access(escapes + nescapes, n, 0);
+		escapes[nescapes++].hi = n->value + 1;
+	}
+	if (n->left)
+		find_escapes(n->left, n);
+	if (n->right)
+		find_escapes(n->right, n);
+}
+
+static unsigned escaped(register struct access *a)
+{
+	register struct access *e = escapes;
+	while (e < escapes + nescapes)
+		if (overlaps(a, e++))
+			return 1;
+	return 0;
+}
+
+static void find_writes(register struct node *n, register struct loop *l)
+{
+	if (is_assign(n->op) && is_local(n->left)) {
+		if (l->nwrite < LSR_WRITES)
+			set_access(l->write + l->nwrite, n->left, 0);
+		if (l->nwrite <= LSR_WRITES)
+			l->nwrite++;
+	}
+	if (n->left)
+		find_writes(n->left, l);
+	if (n->right)
+		find_writes(n->right, l);
+}
+
+static unsigned written(register struct access *a, register struct loop *l)
+{
+	register unsigned i;
+	if (l->nwrite > LSR_WRITES)
+		return 1;
+	for (i = 0; i < l->nwrite; i++)
+		if (overlaps(a, l->write + i))
+			return 1;
+	return 0;
+}
+
+/* A load of the loop counter, possibly made unsigned for the maths */
+static unsigned is_ivar(register struct node *n, register struct loop *l)
+{
+	if (n->op == T_CAST) {
+		if (local_size(n->type) != 2)
+			return 0;
+		n = n->right;
+	}
+	if (n->op != T_DEREF || (n->flags & SIDEEFFECT))
+		return 0;
+	n = n->right;
+	return n->op == l->ivar.op && n->value == l->ivar.lo;
+}
+
+/* The address of something, or a local that holds one */
+static unsigned lsr_base(register struct node *n)
+{
+	if (n->flags & (LVAL | SIDEEFFECT))
+		return 0;
+	if (is_var(n))
+		return 1;
+	return n->op == T_DEREF && is_local(n->right) &&
+		!(n->right->flags & SIDEEFFECT);
+}
+
+/* base + i or base + i * scale, giving the scale */
+static unsigned lsr_index(register struct node *n, register struct loop *l)
+{
+	register struct node *r = n->right;
+
+	if (n->op != T_PLUS || !lsr_base(n->left))
+		return 0;
+	if (is_ivar(r, l))
+		return 1;
+	if (r->op == T_STAR && r->right->op == T_CONSTANT && is_ivar(r->left, l))
+		return r->right->value;
+	return 0;
+}
+
+/* How much keeping it in a local saves each time it is used */
+static unsigned lsr_weight(register struct node *n, unsigned scale)
+{
+	register unsigned w = 1;
+
+	if (n->left->op == T_DEREF)
+		w++;
+	if (scale & (scale - 1))
+		w += 4;
+	else if (scale > 1)
+		w++;
+	return w;
+}
+
+static void lsr_find(register struct node *n, register struct loop *l)
+{
+	register struct lsr_ptr *p;
+	unsigned scale = lsr_index(n, l);
+
+	if (scale) {
+		for (p = l->ptr; p < l->ptr + l->nptr; p++) {
+			if (p->scale == scale && same_tree(n->left, p->pat->left))
+				break;
+		}
+		if (p == l->ptr + LSR_PTRS)
+			return;
+		if (p == l->ptr + l->nptr) {
+			p->pat = copy_tree(n);
+			p->scale = scale;
+			p->weight = 0;
+			p->slot = 0;
+			l->nptr++;
+		}
+		p->weight += lsr_weight(n, scale);
+		return;
+	}
+	if (n->left)
+		lsr_find(n->left, l);
+	if (n->right)
+		lsr_find(n->right, l);
+}
+
+/* The step has to be the counter going up or down by a constant */
+static void lsr_step(register struct node *n, register struct loop *l)
+{
+	register unsigned op = n->op;
+
+	if (op != T_PLUSPLUS && op != T_MINUSMINUS && op != T_PLUSEQ &&
+	    op != T_MINUSEQ)
+		return;
+	if (!is_local(n->left) || n->right->op != T_CONSTANT)
+		return;
+	if ((n->left->type != CSHORT && n->left->type != USHORT) || !l->ok)
+		return;
+	set_access(&l->ivar, n->left, 0);
+	l->step = n->right->value;
+	l->down = op == T_MINUSMINUS || op == T_MINUSEQ;
+	l->ok = 2;
+}
+
+static struct loop *top_loop(void)
+{
+	if (loop_depth && loop_depth <= LSR_DEPTH)
+		return open_loop[loop_depth - 1];
+	return NULL;
+}
+
+static void lsr_header(struct header *h)
+{
+	register struct loop *l;
+	register unsigned i;
+
+	switch(h->h_type) {
+	case H_FOR:
+		l = NULL;
+		if (loop_depth < LSR_DEPTH && nloops < LSR_LOOPS) {
+			l = loops + nloops++;
+			memset(l, 0, sizeof(*l));
+			l->tag = h->h_name;
+			l->init = tree_num;
+			l->ok = 1;
+		}
+		if (loop_depth < LSR_DEPTH)
+			open_loop[loop_depth] = l;
+		else for (i = 0; i < LSR_DEPTH; i++)
+			if (open_loop[i])
+				open_loop[i]->ok = 0;
+		loop_depth++;
+		break;
+	case H_FOR | H_FOOTER:
+		l = top_loop();
+		if (l)
+			l->end = tree_num;
+		loop_depth--;
+		break;
+	case H_LABEL:
+	case H_CASE:
+	case H_DEFAULT:
+		/* We can't be jumped into. Cases are fine if the switch is
+		   within the loop, which it is if it has a later tag */
+		for (i = 0; i < loop_depth && i < LSR_DEPTH; i++) {
+			l = open_loop[i];
+			if (l && (h->h_type == H_LABEL || h->h_name < l->tag))
+				l->ok = 0;
+		}
+		break;
+	}
+}
+
+static struct node *lsr_scan(register struct node *n)
+{
+	register struct loop *top = top_loop();
+	register struct loop *l;
+	register unsigned i;
+
+	find_escapes(n, NULL);
+	for (i = 0; i < loop_depth && i < LSR_DEPTH; i++) {
+		l = open_loop[i];
+		if (l == NULL)
+			continue;
+		if (l == top && for_part) {
+			/* Our own init runs before we can set up, and we need
+			   to see the step before we know what to look for in
+			   the condition */
+			if (for_part == 2) {
+				l->cond = n;
+				find_writes(n, l);
+				n = NULL;
+			} else if (for_part == 1) {
+				lsr_step(n, l);
+				if (l->cond) {
+					if (l->ok == 2)
+						lsr_find(l->cond, l);
+					free_tree(l->cond);
+					l->cond = NULL;
+				}
+			}
+			continue;
+		}
+		find_writes(n, l);
+		if (l->ok == 2)
+			lsr_find(n, l);
+	}
+	return n;
+}
+
+/* Once we have seen the whole function pick the ones worth doing */
+static void lsr_choose(void)
+{
+	register struct loop *l;
+	register struct lsr_ptr *p;
+	struct access a;
+
+	for (l = loops; l < loops + nloops; l++) {
+		if (l->ok != 2 || written(&l->ivar, l) || escaped(&l->ivar))
+			continue;
+		for (p = l->ptr; p < l->ptr + l->nptr; p++) {
+			if (p->weight < LSR_WEIGHT)
+				continue;
+			if (p->pat->left->op == T_DEREF) {
+				set_access(&a, p->pat->left->right, 0);
+				if (written(&a, l) || escaped(&a))
+					continue;
+			}
+			p->slot = ++lsr_slots;
+		}
+	}
+}
+
+static struct node *lsr_replace(register struct node *n, register struct loop *l)
+{
+	register struct lsr_ptr *p;
+	struct node *r;
+	unsigned scale = lsr_index(n, l);
+
+	if (scale) {
+		for (p = l->ptr; p < l->ptr + l->nptr; p++) {
+			if (p->slot && p->scale == scale &&
+			    same_tree(n->left, p->pat->left)) {
+				r = temp_ref(n, p->slot - 1);
+				free_tree(n);
+				return r;
+			}
+		}
+		return n;
+	}
+	if (n->left)
+		n->left = lsr_replace(n->left, l);
+	if (n->right)
+		n->right = lsr_replace(n->right, l);
+	return n;
+}
+
+/* Do a and then b */
+static struct node *lsr_then(struct node *a, struct node *b)
+{
+	register struct node *n;
+	if (a->op == T_NULL) {
+		free_node(a);
+		return b;
+	}
+	n = new_node();
+	n->op = T_COMMA;
+	n->type = b->type;
+	n->flags = NORETURN;
+	n->left = a;
+	n->right = b;
+	return n;
+}
+
+static struct node *lsr_rewrite(register struct node *n)
+{
+	register struct loop *l;
+	register struct lsr_ptr *p;
+	struct node *s;
+	unsigned slot;
+
+	for (l = loops; l < loops + nloops; l++)
+		if (tree_num > l->init + 0 && tree_num != l->init + 2 &&
+		    tree_num < l->end)
+			n = lsr_replace(n, l);
+	for (l = loops; l < loops + nloops; l++) {
+		for (p = l->ptr; p < l->ptr + l->nptr; p++) {
+			if (p->slot == 0)
+				continue;
+			slot = p->slot - 1;
+			if (tree_num == l->init)
+				n = lsr_then(n, temp_assign(copy_tree(p->pat), slot));
+			else if (tree_num == l->init + 2) {
+				s = new_node();
+				s->op = l->down ? T_MINUSEQ : T_PLUSEQ;
+				s->flags = SIDEEFFECT | NORETURN;
+				s->left = temp_local(p->pat, slot);
+				s->type = s->left->type;
+				s->right = new_node();
+				s->right->op = T_CONSTANT;
+				s->right->type = USHORT;
+				s->right->value = (l->step * p->scale) & 0xFFFF;
+				n = lsr_then(n, s);
+#ifdef CONFIG_HOSTED
+				lsr_count++;
+#endif
+			}
+		}
+	}
+	return n;
+}
+
+/*
+ *	Once the loops have been done the common subexpressions are done a
+ *	statement at a time
+ */
+
+static void cse_header(struct header *h)
+{
+	if (h->h_type == H_RETURN)
+		in_return = 1;
+	else if (h->h_type == (H_RETURN | H_FOOTER))
+		in_return = 0;
+}
+
+static struct node *cse_rewrite(struct node *n)
+{
+	/* Only statements and return values. Conditions are left as they
+	   are as the backends look at the top of them to generate branches */
+	if ((n->flags & NORETURN) || in_return)
+		return cse_tree(n);
+	return n;
+}
+
+/* The rewrite goes by tree number so has no use for them */
+static void lsr_no_header(struct header *h)
+{
+}
+
+static void loops_reduce(void)
+{
+	register struct loop *l;
+	register struct lsr_ptr *p;
+
+	nloops = 0;
+	loop_depth = 0;
+	lsr_slots = 0;
+	nescapes = 0;
+	walk_function(lsr_header, lsr_scan, 0);
+	lsr_choose();
+	if (lsr_slots)
+		walk_function(lsr_no_header, lsr_rewrite, 1);
+	for (l = loops; l < loops + nloops; l++)
+		for (p = l->ptr; p < l->ptr + l->nptr; p++)
+			free_tree(p->pat);
+}
+
+static void end_function(void)
+{
+	struct header h;
+
+	if (passthru) {
+		passthru = 0;
+		return;
+	}
+	loops_reduce();
+	in_return = 0;
+	if (!no_room)
+		walk_function(cse_header, cse_rewrite, 1);
+	/* If a rewrite was given up the locals are not used, which is
+	   harmless */
+	if (temp_max + lsr_slots) {
+		memcpy(&h, outbuf + frame_pos, sizeof(h));
+		h.h_name = temp_offset(temp_max + lsr_slots);
+		memcpy(outbuf + frame_pos, &h, sizeof(h));
+	}
+	if (!no_room)
+		dead_stores();
+	no_room = 0;
+	infunc = 0;
+}
+
+static void process_header(void)
+{
+	struct header h;
+
+	in_read(&h, sizeof(struct header));
+	put_block("%H", 2);
+
+	switch (h.h_type) {
+	case H_FUNCTION:
+		func_pos = outlen - 2;
+		infunc = 1;
+		temp_max = 0;
+		ntrees = 0;
+		frame_len = 0;
+		break;
+	case H_FRAME:
+		frame_pos = outlen;
+		frame_len = h.h_name;
+		frame_flags = h.h_data;
+		break;
+	}
+	put_block(&h, sizeof(struct header));
+	if (h.h_type == H_STRING)
+		process_literal();
+	if (h.h_type == (H_FUNCTION | H_FOOTER))
+		end_function();
+}
+
+int main(int argc, char *argv[])
+{
+	uint8_t h[2];
+
+	argv0 = argv[0];
+
+	while (in_block(h, 2) == 2) {
+		if (h[0] != '%')
+			error("sync");
+		if (h[1] == '^')
+			process_tree();
+		else if (h[1] == 'H')
+			process_header();
+		else if (h[1] == '[')
+			process_data();
+		else
+			error("unknown block");
+		if (!infunc)
+			put_flush();
+	}
+	put_flush();
+#ifdef CONFIG_HOSTED
+	/* Report our counters if the driver is collecting statistics */
+	stats_printf("pass=cc1b trees=%lu cse=%lu dse=%lu lsr=%lu\n",
+		trees, cse_count, dse_count, lsr_count);
+#endif
+	return 0;
+}
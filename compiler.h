@@ -2,9 +2,17 @@
 /* Pass 2 values */
 
 /* This controls the number of symbols (including complex types, arrays and
-   unique function prototypes. Cost is 10 bytes per node on a small box. We
-   can probably make symbols the self expanding one eventually */
+   unique function prototypes. Cost is 10 bytes per node on a small box,
+   2 of them the name hash chain, so 10K for a native cc1.
+   The table cannot move as the slot number is part of the type encoding,
+   and only the first 1024 slots can hold types */
+#ifdef CONFIG_HOSTED
+#define MAXSYM			8192
+/* so a hosted build keeps those for types and puts named symbols above */
+#define TYPESYM			1024
+#else
 #define MAXSYM			1024
+#endif
 /* Expression nodes. Currently 16 bytes on a small box will be about 24 once
    we have everything in */
 #define NUM_NODES		100
@@ -15,11 +23,19 @@
 /* Maximum number of fields per structure, 6 bytes per entry on stack, per
    recursive struct definition */
 #define NUM_STRUCT_FIELD	50
-/* Number of switch entries within the current scope. 4 bytes per entry */
+/* Number of switch entries within the current scope. 6 bytes per entry */
 #define NUM_SWITCH		128
+/* Switches with at least this many cases are worth a binary search */
+#define SWITCH_SEARCH_MIN	8
+/* and with this many nearly contiguous cases worth a jump table */
+#define SWITCH_DENSE_MIN	4
 /* Number of constants from enum. 4 bytes per entry */
 #define NUM_CONSTANT		50
 
+/* On a hosted build memory is cheap so the node, index, label and switch
+   pools are not limits. They start at the sizes above and grow from the
+   pool allocator as needed */
+
 #include <stdio.h>
 
 #include "symbol.h"
@@ -6,15 +6,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#include "stats.h"
 
 int rpn_eval(const char* expr, char** vars);
+struct onode;
+void compile(struct onode* o);
 
-#define HSIZE 107
+#define HSIZE 1024 /* initial string table size, must be a power of 2 */
+#define ARENASIZE 16384
 #define MAXLINE 128
 #define MAXFIRECOUNT 65535L
 #define MAX_PASS 16
+#define OHSIZE 127
 
 int debug = 0;
+int stats = 0;
+int profile = 0;
 
 int global_again = 0; /* signalize that rule set has changed */
 #define FIRSTLAB 'L'
@@ -25,14 +34,72 @@ int labnum[LASTLAB - FIRSTLAB + 1]; /* unique label numbers */
 struct lnode {
     char* l_text;
     struct lnode *l_prev, *l_next;
+    int l_gen; /* rules up to this generation fail here, -1 if dirty */
+};
+
+/* A pattern line compiled for matching. p_code is a sequence of
+   M_LIT len chars, M_VAR n terminator, M_BAD, ending with M_END */
+struct pline {
+    char* p_text;
+    int p_kind;
+    unsigned char* p_code;
+};
+
+#define P_MATCH 0
+#define P_CHECK 1
+#define P_EVAL 2
+
+#define M_END 0
+#define M_LIT 1
+#define M_VAR 2
+#define M_BAD 3
+
+/* A variable captured by the current match, pointing into the line */
+struct capture {
+    char* c_ptr;
+    int c_len;
 };
 
 struct onode {
     struct lnode *o_old, *o_new;
+    struct pline* o_prog; /* o_old compiled, last line first */
+    int o_nprog;
     struct onode* o_next;
     long firecount;
+    int o_seq; /* position in opts */
+    int o_gen; /* activation generation that created the rule */
+    int o_keylen; /* literal prefix of the last pattern line */
+    struct onode* o_hnext; /* next rule in the same index chain */
+    char* o_file; /* where the rule came from, for -P */
+    int o_line;
+    int o_activated;
+    long o_tries, o_matches, o_fires; /* profile counters for -P */
+    unsigned long o_time;
 }* opts = 0, *activerule = 0;
 
+char* rulefile; /* rules file being read */
+int lineno;
+int rulestart; /* line the current rule pattern starts on */
+
+/* Rules indexed by the first token of their last pattern line. Rules
+   whose last line does not begin with a complete literal token live on
+   the wildcard chain and are tried against every line. Both chains are
+   kept in opts order so the first matching rule still wins */
+struct onode* otab[OHSIZE];
+struct onode* owild;
+int nrules;
+
+/* Once a line has been tried against every rule and nothing fired it is
+   marked with the current rule generation. Later passes only try rules
+   activated since then, unless a rewrite within maxwin lines before it
+   has dirtied the line again */
+int rulegen;
+int maxwin = 1;
+
+/* statistics for -S */
+long nlines, nclean, ntried, nscanned, nfired;
+long narena, nstrings, nlnodes, nlreuse;
+
 void printlines(struct lnode* beg, struct lnode* end, FILE* out)
 {
     struct lnode* p;
@@ -70,48 +137,254 @@ void connect(struct lnode* p1, struct lnode* p2)
     p2->l_prev = p1;
 }
 
+/* tokhash - hash the leading token of s, return its length in *len */
+int tokhash(char* s, int* len)
+{
+    register char* p = s;
+    register unsigned h = 0;
+
+    while (*p == ' ' || *p == '\t')
+        h = h * 31 + *p++;
+    while (*p && *p != ' ' && *p != '\t' && *p != '\n')
+        h = h * 31 + *p++;
+    if (*p)
+        h = h * 31 + *p++;
+    *len = p - s;
+    return h % OHSIZE;
+}
+
+/* reindex - rebuild the rule index after the rule list changes */
+void reindex(void)
+{
+    struct onode *o, **tail[OHSIZE], **wtail;
+    int i, h, len;
+
+    for (i = 0; i < OHSIZE; i++) {
+        otab[i] = 0;
+        tail[i] = &otab[i];
+    }
+    owild = 0;
+    wtail = &owild;
+    nrules = 0;
+
+    for (o = opts; o; o = o->o_next) {
+        o->o_seq = nrules++;
+        o->o_hnext = 0;
+        o->o_keylen = strcspn(o->o_old->l_text, "%");
+        if (o->o_prog == 0)
+            compile(o);
+        for (i = 0, h = 0; h < o->o_nprog; h++)
+            if (o->o_prog[h].p_kind == P_MATCH)
+                i++;
+        if (i > maxwin)
+            maxwin = i;
+        h = tokhash(o->o_old->l_text, &len);
+        if (len <= o->o_keylen) {
+            *tail[h] = o;
+            tail[h] = &o->o_hnext;
+        } else {
+            *wtail = o;
+            wtail = &o->o_hnext;
+        }
+    }
+}
+
+/* candidates - find the first indexed rules after seq that may end at r */
+void candidates(struct lnode* r, int seq, struct onode** b, struct onode** w)
+{
+    int len;
+
+    for (*b = otab[tokhash(r->l_text, &len)]; *b && (*b)->o_seq <= seq;)
+        *b = (*b)->o_hnext;
+    for (*w = owild; *w && (*w)->o_seq <= seq;)
+        *w = (*w)->o_hnext;
+}
+
+/* nextrule - return the next candidate rule in opts order */
+struct onode* nextrule(struct onode** b, struct onode** w)
+{
+    struct onode* o;
+
+    if (*b && (*w == 0 || (*b)->o_seq < (*w)->o_seq)) {
+        o = *b;
+        *b = o->o_hnext;
+    } else if ((o = *w) != 0)
+        *w = o->o_hnext;
+    return o;
+}
+
+/* arena - allocate n bytes from large blocks that are never freed */
+void* arena(unsigned n)
+{
+    static char *next, *end;
+
+    n = (n + sizeof(char*) - 1) & ~(sizeof(char*) - 1);
+    if (next == 0 || end - next < n) {
+        unsigned size = n > ARENASIZE ? n : ARENASIZE;
+        next = (char*)malloc(size);
+        if (next == NULL)
+            error("arena: out of memory\n");
+        end = next + size;
+        ++narena;
+    }
+    next += n;
+    return next - n;
+}
+
 /* install - install str in string table */
 char* install(char* str)
 {
     register struct hnode* p;
-    register char *p1, *p2, *s;
-    register int i;
+    register unsigned char* s;
+    register unsigned h;
+    unsigned i;
     static struct hnode {
         char* h_str;
+        unsigned h_hash;
         struct hnode* h_ptr;
-    } * htab[HSIZE] = { 0 };
+    } **htab;
+    static unsigned hsize;
 
-    s = str;
-    for (i = 0; *s; i += *s++)
-        ;
-    i = abs(i) % HSIZE;
+    /* FNV-1a */
+    h = 2166136261U;
+    for (s = (unsigned char*)str; *s; s++)
+        h = (h ^ *s) * 16777619U;
 
-    for (p = htab[i]; p; p = p->h_ptr)
-        for (p1 = str, p2 = p->h_str; *p1++ == *p2++;)
-            if (p1[-1] == '\0')
+    if (htab)
+        for (p = htab[h & (hsize - 1)]; p; p = p->h_ptr)
+            if (p->h_hash == h && strcmp(p->h_str, str) == 0)
                 return (p->h_str);
 
-    p = (struct hnode*)malloc(sizeof *p);
-    if (p == NULL)
-        error("install 1: out of memory\n");
-    p->h_str = (char*)malloc((s - str) + 1);
-    if (p->h_str == NULL)
-        error("install 2: out of memory\n");
+    /* keep the chains short by doubling the table as it fills */
+    if (nstrings >= hsize) {
+        struct hnode **old = htab, *q;
+        unsigned osize = hsize;
+
+        hsize = hsize ? 2 * hsize : HSIZE;
+        htab = (struct hnode**)calloc(hsize, sizeof *htab);
+        if (htab == NULL)
+            error("install 1: out of memory\n");
+        for (i = 0; i < osize; i++)
+            for (p = old[i]; p; p = q) {
+                q = p->h_ptr;
+                p->h_ptr = htab[p->h_hash & (hsize - 1)];
+                htab[p->h_hash & (hsize - 1)] = p;
+            }
+        free(old);
+    }
+
+    p = (struct hnode*)arena(sizeof(struct hnode) + ((char*)s - str) + 1);
+    p->h_str = (char*)(p + 1);
     strcpy(p->h_str, str);
-    p->h_ptr = htab[i];
-    htab[i] = p;
+    p->h_hash = h;
+    p->h_ptr = htab[h & (hsize - 1)];
+    htab[h & (hsize - 1)] = p;
+    ++nstrings;
     return (p->h_str);
 }
 
+/* literal - add c to the literal run being built at cp */
+unsigned char* literal(unsigned char* cp, unsigned char** run, int c)
+{
+    if (*run == 0 || **run == 255) {
+        *cp++ = M_LIT;
+        *run = cp++;
+        **run = 0;
+    }
+    *cp++ = c;
+    ++**run;
+    return cp;
+}
+
+/* compile_line - compile one pattern line into match code */
+unsigned char* compile_line(char* pat)
+{
+    unsigned char code[3 * MAXLINE + 2], *cp = code, *run = 0, *p;
+
+    while (*pat) {
+        if (pat[0] == '%' && pat[1] >= '0' && pat[1] <= '9') {
+            if (pat[2] == '%' && pat[3] != '%') {
+                *cp++ = M_BAD;
+                break;
+            }
+            *cp++ = M_VAR;
+            *cp++ = pat[1] - '0';
+            *cp++ = pat[2];
+            pat += 2;
+            run = 0;
+        } else if (pat[0] == '%' && pat[1] == '%') {
+            /* %% matches % and the character after it is always literal */
+            cp = literal(cp, &run, '%');
+            pat += 2;
+            if (*pat)
+                cp = literal(cp, &run, *pat++);
+        } else
+            cp = literal(cp, &run, *pat++);
+    }
+    *cp++ = M_END;
+    p = (unsigned char*)arena(cp - code);
+    memcpy(p, code, cp - code);
+    return p;
+}
+
+/* compile - compile the pattern of a rule, last line first */
+void compile(struct onode* o)
+{
+    struct lnode* p;
+    struct pline* pl;
+    int n;
+
+    for (n = 0, p = o->o_old; p; p = p->l_prev)
+        n++;
+    o->o_prog = pl = (struct pline*)arena(n * sizeof *pl);
+    o->o_nprog = n;
+    for (p = o->o_old; p; p = p->l_prev, pl++) {
+        pl->p_text = p->l_text;
+        pl->p_code = 0;
+        if (strncmp(p->l_text, "%check", 6) == 0)
+            pl->p_kind = P_CHECK;
+        else if (strncmp(p->l_text, "%eval", 5) == 0)
+            pl->p_kind = P_EVAL;
+        else {
+            pl->p_kind = P_MATCH;
+            pl->p_code = compile_line(p->l_text);
+        }
+    }
+}
+
+/* Free lnodes are chained through l_next for reuse */
+struct lnode* lfree;
+
+/* lalloc - allocate a line node */
+struct lnode* lalloc(void)
+{
+    struct lnode* n;
+
+    if ((n = lfree) != 0) {
+        lfree = n->l_next;
+        ++nlreuse;
+    } else {
+        n = (struct lnode*)arena(sizeof *n);
+        ++nlnodes;
+    }
+    return n;
+}
+
+/* lrelease - return a line node for reuse */
+void lrelease(struct lnode* n)
+{
+    n->l_next = lfree;
+    lfree = n;
+}
+
 /* insert - insert a new node with text s before node p */
 void insert(char* s, struct lnode* p)
 {
     struct lnode* n;
 
-    n = (struct lnode*)malloc(sizeof *n);
-    if (n == NULL)
-        error("insert: out of memory\n");
+    n = lalloc();
     n->l_text = s;
+    n->l_gen = -1;
     connect(p->l_prev, n);
     connect(n, p);
 }
@@ -122,7 +395,10 @@ void getlst(FILE* fp, char* quit, struct lnode* p1, struct lnode* p2)
     char lin[MAXLINE];
 
     connect(p1, p2);
-    while (fgets(lin, MAXLINE, fp) != NULL && strcmp(lin, quit)) {
+    while (fgets(lin, MAXLINE, fp) != NULL) {
+        ++lineno;
+        if (strcmp(lin, quit) == 0)
+            break;
         insert(install(lin), p2);
     }
 }
@@ -135,7 +411,10 @@ void getlst_1(FILE* fp, char* quit, struct lnode* p1, struct lnode* p2)
     int firstline = 1;
 
     connect(p1, p2);
-    while (fgets(lin, MAXLINE, fp) != NULL && strcmp(lin, quit)) {
+    while (fgets(lin, MAXLINE, fp) != NULL) {
+        ++lineno;
+        if (strcmp(lin, quit) == 0)
+            break;
         if (firstline) {
             char* p = lin;
             if (lin[0] == '#')
@@ -145,11 +424,26 @@ void getlst_1(FILE* fp, char* quit, struct lnode* p1, struct lnode* p2)
             if (!*p)
                 continue;
             firstline = 0;
+            rulestart = lineno;
         }
         insert(install(lin), p2);
     }
 }
 
+/* newrule - allocate an empty rule */
+struct onode* newrule(char* file, int line)
+{
+    struct onode* p;
+
+    p = (struct onode*)calloc(1, sizeof(struct onode));
+    if (p == NULL)
+        error("rule: out of memory\n");
+    p->firecount = MAXFIRECOUNT;
+    p->o_file = file;
+    p->o_line = line;
+    return p;
+}
+
 /* init - read patterns file */
 void init(FILE* fp)
 {
@@ -159,12 +453,11 @@ void init(FILE* fp)
     next = &opts;
     while (*next)
         next = &((*next)->o_next);
+    lineno = 0;
     while (!feof(fp)) {
-        p = (struct onode*)malloc((unsigned)sizeof(struct onode));
-        if (p == NULL)
-            error("init: out of memory\n");
-        p->firecount = MAXFIRECOUNT;
+        p = newrule(rulefile, 0);
         getlst_1(fp, "=\n", &head, &tail);
+        p->o_line = rulestart;
         head.l_next->l_prev = 0;
         if (tail.l_prev)
             tail.l_prev->l_next = 0;
@@ -220,53 +513,62 @@ int check_eval(char* pat, char** vars)
     return expected == rpn_eval(expr, vars);
 }
 
-/* match - match ins against pat and set vars */
-int match(char* ins, char* pat, char** vars)
+/* match - match ins against a compiled pattern line, capturing vars */
+int match(char* ins, struct pline* pl, struct capture* cap)
 {
-    char *p, lin[MAXLINE], *start = pat;
-
-    while (*ins && *pat)
-        if (pat[0] == '%') {
-            switch (pat[1]) {
-            case '%':
-                if (*pat != *ins++)
-                    return 0;
-                pat += 2;
-                break;
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-                if (pat[2] == '%' && pat[3] != '%') {
-                    fprintf(stderr, "error in \"%s\": ", start);
-                    error("input pattern %n% is not allowed\n");
-                }
-                for (p = lin; *ins && *ins != pat[2];)
-                    *p++ = *ins++;
-                *p = 0;
-                p = install(lin);
-                if (vars[pat[1] - '0'] == 0)
-                    vars[pat[1] - '0'] = p;
-                else if (vars[pat[1] - '0'] != p)
-                    return 0;
-                pat += 2;
-                continue;
+    char *end = ins + strlen(ins), *p;
+    unsigned char* code = pl->p_code;
+    struct capture* v;
+    int n;
 
-            default:
-                break;
-            }
-            if (*pat++ != *ins++)
+    for (;;) {
+        switch (*code++) {
+        case M_LIT:
+            n = *code++;
+            if (end - ins < n || memcmp(ins, code, n))
+                return 0;
+            ins += n;
+            code += n;
+            break;
+        case M_VAR:
+            if (ins == end)
                 return 0;
-        } else if (*pat++ != *ins++)
-            return 0;
+            v = &cap[*code++];
+            p = *code ? memchr(ins, *code, end - ins) : 0;
+            code++;
+            if (p == 0)
+                p = end;
+            if (v->c_ptr == 0) {
+                v->c_ptr = ins;
+                v->c_len = p - ins;
+            } else if (v->c_len != p - ins || memcmp(v->c_ptr, ins, p - ins))
+                return 0;
+            ins = p;
+            break;
+        case M_BAD:
+            fprintf(stderr, "error in \"%s\": ", pl->p_text);
+            error("input pattern %n% is not allowed\n");
+        default:
+            return ins == end; /* compare end of string */
+        }
+    }
+}
 
-    return *pat == *ins; /* compare end of string */
+/* capvars - copy the variables captured so far for %check and %eval */
+char** capvars(struct capture* cap, char** vars)
+{
+    static char buf[10][MAXLINE];
+    int i;
+
+    for (i = 0; i < 10; i++) {
+        vars[i] = 0;
+        if (cap[i].c_ptr) {
+            memcpy(buf[i], cap[i].c_ptr, cap[i].c_len);
+            buf[i][cap[i].c_len] = 0;
+            vars[i] = buf[i];
+        }
+    }
+    return vars;
 }
 
 /* subst_imp - return result of substituting vars into pat */
@@ -343,9 +645,12 @@ struct lnode* rep(
         psav = p->l_next;
         if (debug)
             fputs(p->l_text, stderr);
-        free(p);
+        lrelease(p);
     }
     connect(p1, p2);
+    /* lines whose window reaches back into the rewrite must be retried */
+    for (p = p2, i = 0; p && i < maxwin; p = p->l_next, i++)
+        p->l_gen = -1;
     if (debug)
         fputs("=\n", stderr);
     for (; new; new = new->l_next) {
@@ -400,49 +705,129 @@ struct lnode* copylist(
     return more;
 }
 
+/* ticks - clock for -P, in nanoseconds where the host has one */
+unsigned long ticks(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+#else
+    return clock() * (1000000000UL / CLOCKS_PER_SEC);
+#endif
+}
+
+/* costlier - qsort helper putting the most expensive rules first */
+int costlier(const void* a, const void* b)
+{
+    const struct onode* x = *(const struct onode**)a;
+    const struct onode* y = *(const struct onode**)b;
+
+    if (x->o_time != y->o_time)
+        return x->o_time < y->o_time ? 1 : -1;
+    if (x->o_tries != y->o_tries)
+        return x->o_tries < y->o_tries ? 1 : -1;
+    return x->o_seq - y->o_seq;
+}
+
+/* report - print the -P rule profile */
+void report(FILE* out)
+{
+    struct onode **v, *o;
+    struct lnode* l;
+    char* p;
+    int i;
+
+    v = (struct onode**)malloc(nrules * sizeof *v + 1);
+    if (v == NULL)
+        error("report: out of memory\n");
+    for (i = 0, o = opts; o; o = o->o_next)
+        v[i++] = o;
+    qsort(v, nrules, sizeof *v, costlier);
+
+    fprintf(out, "%10s %9s %9s %9s  %s\n", "time(us)", "tries", "matches",
+        "fires", "rule");
+    for (i = 0; i < nrules; i++) {
+        o = v[i];
+        for (l = o->o_old; l->l_prev; l = l->l_prev)
+            ;
+        for (p = l->l_text; *p == ' ' || *p == '\t'; p++)
+            ;
+        fprintf(out, "%10lu %9ld %9ld %9ld  %s:%d%s %.*s\n",
+            o->o_time / 1000, o->o_tries, o->o_matches, o->o_fires,
+            o->o_file, o->o_line, o->o_activated ? "+" : "",
+            (int)strcspn(p, "\n"), p);
+    }
+    free(v);
+}
+
 /* opt - replace instructions ending at r if possible */
 struct lnode* opt(struct lnode* r)
 {
-    char* vars[10];
-    int i, lines;
+    char *vars[10], lin[MAXLINE];
+    struct capture cap[10];
+    int i, n, lines, from = 0, gen = r->l_gen;
+    unsigned long t = 0;
     struct lnode *c, *p;
-    struct onode* o;
+    struct pline* pl;
+    struct onode *o, *b, *w;
     static char* activated = "%activated ";
 
-    for (o = opts; o; o = o->o_next) {
+    ++nlines;
+    if (gen == rulegen) {
+        ++nclean;
+        nscanned += nrules;
+        return r->l_next;
+    }
+    candidates(r, -1, &b, &w);
+    while ((o = nextrule(&b, &w)) != 0) {
         activerule = o;
-        if (o->firecount < 1)
+        if (o->firecount < 1 || o->o_gen <= gen)
+            continue;
+        if (strncmp(r->l_text, o->o_old->l_text, o->o_keylen))
             continue;
+        ++ntried;
+        ++o->o_tries;
+        if (profile)
+            t = ticks();
         c = r;
-        p = o->o_old;
         if (debug) {
             fprintf(stderr, "Trying rule: ");
             printrule(o, stderr);
         }
-        if (p == 0)
-            continue; /* skip empty rules */
         for (i = 0; i < 10; i++)
-            vars[i] = 0;
+            cap[i].c_ptr = 0;
         lines = 0;
-        while (p && c) {
-            if (strncmp(p->l_text, "%check", 6) == 0) {
-                if (!check(p->l_text + 6, vars))
+        for (pl = o->o_prog, n = o->o_nprog; n && c; pl++, n--) {
+            if (pl->p_kind == P_CHECK) {
+                if (!check(pl->p_text + 6, capvars(cap, vars)))
                     break;
-            } else if ( strncmp(p->l_text, "%eval", 5) == 0 ) {
-                if (!check_eval(p->l_text + 5, vars))
+            } else if (pl->p_kind == P_EVAL) {
+                if (!check_eval(pl->p_text + 5, capvars(cap, vars)))
                     break;
             } else {
-//                fprintf(stderr, "Matching '%s', '%s'.\n",
-//                    c->l_text, p->l_text);
-                if (!match(c->l_text, p->l_text, vars))
+                if (!match(c->l_text, pl, cap))
                     break;
                 c = c->l_prev;
                 ++lines;
             }
-            p = p->l_prev;
         }
-        if (p != 0)
+        if (profile)
+            o->o_time += ticks() - t;
+        if (n != 0)
             continue;
+        ++o->o_matches;
+
+        /* only now turn the captures into strings */
+        for (i = 0; i < 10; i++) {
+            vars[i] = 0;
+            if (cap[i].c_ptr) {
+                memcpy(lin, cap[i].c_ptr, cap[i].c_len);
+                lin[cap[i].c_len] = 0;
+                vars[i] = install(lin);
+            }
+        }
 
         /* decrease firecount */
         --o->firecount;
@@ -452,7 +837,7 @@ struct lnode* opt(struct lnode* r)
             struct lnode* tmp = o->o_new; /* delete the %once line */
             o->o_new = o->o_new->l_next;
             o->o_new->l_prev = 0;
-            free(tmp);
+            lrelease(tmp);
             o->firecount = 0; /* never again */
         }
 
@@ -478,6 +863,7 @@ struct lnode* opt(struct lnode* r)
             }
             if (!lnp || skip)
                 continue;
+            ++o->o_fires;
             insert(install(signature), lnp);
 
             if (debug) {
@@ -491,12 +877,9 @@ struct lnode* opt(struct lnode* r)
             /* allow creation of several rules */
             last = o;
             while (lnp) {
-                nn = (struct onode*)
-                    malloc((unsigned)sizeof(struct onode));
-                if (nn == NULL)
-                    error("activate: out of memory\n");
-                nn->o_old = 0, nn->o_new = 0;
-                nn->firecount = MAXFIRECOUNT;
+                nn = newrule(o->o_file, o->o_line);
+                nn->o_activated = 1;
+                nn->o_gen = rulegen + 1;
                 lnp = copylist(lnp, &nn->o_old, &nn->o_new, vars);
                 nn->o_next = last->o_next;
                 last->o_next = nn;
@@ -513,14 +896,26 @@ struct lnode* opt(struct lnode* r)
             while (--lines && r->l_prev)
                 r = r->l_prev;
             global_again = 1; /* signalize changes */
+            nscanned += o->o_seq + 1 - from;
+            gen = -2; /* r is only partly tried, leave it dirty */
+            ++rulegen;
+            reindex();
+            from = o->o_seq + 1;
+            candidates(r, o->o_seq, &b, &w);
             continue;
         }
 
         /* fire the rule */
+        nscanned += o->o_seq + 1 - from;
+        ++nfired;
+        ++o->o_fires;
         r = rep(c, r->l_next, o->o_new, vars);
         activerule = 0;
         return r;
     }
+    nscanned += nrules - from;
+    if (gen != -2)
+        r->l_gen = rulegen;
     activerule = 0;
     return r->l_next;
 }
@@ -537,15 +932,23 @@ int main(int argc, char** argv)
 
     for (i = 1; i < argc; i++)
         if (strcasecmp(argv[i], "-D") == 0)
-            debug = 1;
+            debug = stats = 1;
+        else if (strcmp(argv[i], "-S") == 0)
+            stats = 1;
+        else if (strcmp(argv[i], "-P") == 0)
+            profile = 1;
         else if ((fp = fopen(argv[i], "r")) == NULL)
             error("copt: can't open patterns file\n");
-        else
+        else {
+            rulefile = argv[i];
             init(fp);
+        }
 
+    reindex();
     getlst(stdin, "", &head, &tail);
 
     head.l_text = tail.l_text = "";
+    head.l_prev = tail.l_next = 0;
 
     pass = 0;
     do {
@@ -563,8 +966,23 @@ int main(int argc, char** argv)
     }
 
     printlines(head.l_next, &tail, stdout);
-    exit(0);
-    return 1; /* make compiler happy */
+    if (stats) {
+        fprintf(stderr, "copt: %d rules, %d passes, %ld lines visited (%ld clean)\n",
+            nrules, pass, nlines, nclean);
+        fprintf(stderr, "copt: %ld rules tried (%ld without index), %ld fired\n",
+            ntried, nscanned, nfired);
+        fprintf(stderr, "copt: %ld strings, %ld lnodes (%ld reused), %ld arena blocks\n",
+            nstrings, nlnodes, nlreuse, narena);
+    }
+    if (profile)
+        report(stderr);
+#ifdef CONFIG_HOSTED
+    /* Report our counters if the driver is collecting statistics */
+    stats_printf("pass=copt lines=%ld tried=%ld fired=%ld passes=%d\n",
+        nlines, ntried, nfired, pass);
+#endif
+    /* Return rather than exit so cc-all can time us */
+    return 0;
 }
 
 #define STACKSIZE 20
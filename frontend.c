@@ -17,6 +17,7 @@
 #include "symtab.h"
 #include "token.h"
 #include "target.h"
+#include "stats.h"
 
 static char *symtab;
 
@@ -257,7 +258,14 @@ static void directive(void)
 }
 
 
+/* Must be a power of two. Hosted builds can afford a bigger table */
+#ifndef NHASH
+#ifdef CONFIG_HOSTED
+#define NHASH	512
+#else
 #define NHASH	64
+#endif
+#endif
 
 /* We could infer the symbol number from the table position in theory */
 
@@ -300,35 +308,98 @@ static struct name *find_symbol(const char *name, unsigned hash)
 }
 
 /*
- *	A simple but adequate hashing algorithm. A better one would
- *	be worth it for performance.
+ *	Rotate and xor each character in, then fold the top half down so
+ *	that small tables still see all of the name. Only shifts and xor
+ *	so it stays cheap on an 8bit micro, but unlike a plain sum it
+ *	cares about the order of the characters.
  */
 static unsigned hash_symbol(const char *name)
 {
-	int hash = 0;
+	uint16_t hash = 0;
 	uint8_t n = 0;
 
 	while (*name && n++ < NAMELEN)
-		hash += *name++;
+		hash = ((hash << 3) | (hash >> 13)) ^ (uint8_t)*name++;
+	hash ^= hash >> 8;
 	return (hash & (NHASH - 1));
 }
 
-static void write_symbol_table(void)
+/*
+ *	Report how long the hash chains got so we can see how well the
+ *	hash is doing on real code
+ */
+static void hash_stats(void)
 {
-	unsigned len = (uint8_t *) nextsym - (uint8_t *) symbase;
-	uint8_t n[2];
+	static unsigned count[17];
+	unsigned i;
+	unsigned n;
+	unsigned probes = 0;
+	struct name *s;
+
+	for (i = 0; i < NHASH; i++) {
+		n = 0;
+		for (s = symhash[i]; s; s = s->next)
+			probes += ++n;
+		count[n > 16 ? 16 : n]++;
+	}
+	writes("names ");
+	writes(_itoa(nextsym - symbols));
+	writes(" buckets ");
+	writes(_itoa(NHASH));
+	writes(" probes ");
+	writes(_itoa(probes));
+	write(2, "\n", 1);
+	for (i = 0; i <= 16; i++) {
+		if (count[i] == 0)
+			continue;
+		writes(_itoa(i));
+		writes(i == 16 ? "+ " : " ");
+		writes(_itoa(count[i]));
+		write(2, "\n", 1);
+	}
+}
+
+/*
+ *	The symbol table is written as we go. Any new names are written out
+ *	before the token block that first uses them, so a later pass reading
+ *	our output down a pipe will always find the names it needs. The
+ *	length at the front is filled in at the end.
+ */
+static int sym_fd;
+static struct name *symdone;	/* Names written so far */
 
+static void open_symbol_table(void)
+{
 	/* FIXME: proper temporary file! */
-	int fd = open(symtab, O_WRONLY | O_CREAT | O_TRUNC, 0600);
-	if (fd == -1) {
+	sym_fd = open(symtab, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (sym_fd == -1) {
 		perror(symtab);
 		exit(1);
 	}
+	if (write(sym_fd, "\0\0", 2) != 2)
+		error("symbol I/O");
+	symdone = symbase;
+}
+
+static void sync_symbol_table(void)
+{
+	unsigned len = (uint8_t *) nextsym - (uint8_t *) symdone;
+	if (len && write(sym_fd, symdone, len) != len)
+		error("symbol I/O");
+	symdone = nextsym;
+}
+
+static void write_symbol_table(void)
+{
+	unsigned len = (uint8_t *) nextsym - (uint8_t *) symbase;
+	uint8_t n[2];
+
+	sync_symbol_table();
 	n[0] = len;
 	n[1] = len >> 8;
-	if (write(fd, n, 2) != 2 || write(fd, symbase, len) != len)
+	if (lseek(sym_fd, 0L, SEEK_SET) < 0 || write(sym_fd, n, 2) != 2)
 		error("symbol I/O");
-	close(fd);
+	close(sym_fd);
 }
 
 /*
@@ -344,6 +415,7 @@ static void outbyte(unsigned char c)
 	*outptr++ = c;
 	if (outptr == outbuf + BLOCK) {
 		outptr = outbuf;
+		sync_symbol_table();
 		if (write(1, outbuf, BLOCK) != BLOCK)
 			error("I/O");
 	}
@@ -352,6 +424,7 @@ static void outbyte(unsigned char c)
 static void outflush(void)
 {
 	unsigned len = outptr - outbuf;
+	sync_symbol_table();
 	if (len && write(1, outbuf, len) != len)
 		error("I/O");
 }
@@ -374,10 +447,17 @@ static void encode_byte(unsigned c)
 	*tokptr++ = c;
 }
 
+#ifdef CONFIG_HOSTED
+static unsigned long tokens;	/* For the driver statistics */
+#endif
+
 static void write_token(unsigned c)
 {
 	unsigned char *tp;
 	unsigned n = 0;
+#ifdef CONFIG_HOSTED
+	tokens++;
+#endif
 	if (oldline != line || filechange) {
 		oldline = line;
 		outbyte(T_LINE & 0xFF);
@@ -1236,7 +1316,8 @@ static unsigned tokenize(void)
 	return T_POT;
 }
 
-/* Tokenizer as a standalone pass */
+/* Tokenizer as a standalone pass. A second -H argument reports the
+   name hash chain lengths on stderr at the end */
 int main(int argc, char *argv[])
 {
 	unsigned t;
@@ -1244,6 +1325,7 @@ int main(int argc, char *argv[])
 	if (symtab == NULL)
 		symtab = ".symtab";
 	keywords();
+	open_symbol_table();
 	do {
 		t = tokenize();
 		write_token(t);
@@ -1251,5 +1333,12 @@ int main(int argc, char *argv[])
 	/* Write the remaining decode */
 	outflush();
 	write_symbol_table();
+	if (argc > 2 && strcmp(argv[2], "-H") == 0)
+		hash_stats();
+#ifdef CONFIG_HOSTED
+	/* Report our counters if the driver is collecting statistics */
+	stats_printf("pass=cc0 tokens=%lu names=%u\n",
+		tokens, (unsigned)(nextsym - symbase));
+#endif
 	return err;
 }
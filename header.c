@@ -24,15 +24,34 @@ void footer(unsigned htype, unsigned name, unsigned data)
 	header(htype | H_FOOTER, name, data);
 }
 
-void rewrite_header(unsigned long pos, unsigned htype, unsigned name, unsigned data)
+/* Go back to a marked position to rewrite what is there. Returns where
+   to come back to */
+unsigned long rewrite_start(unsigned long pos)
 {
 	unsigned long curr = out_tell();
 	out_seek(pos);
-	header(htype, name, data);
+	return curr;
+}
+
+void rewrite_end(unsigned long curr)
+{
 	out_seek(curr);
+#ifdef CONFIG_HOSTED
+	out_hold(0);
+#endif
+}
+
+void rewrite_header(unsigned long pos, unsigned htype, unsigned name, unsigned data)
+{
+	unsigned long curr = rewrite_start(pos);
+	header(htype, name, data);
+	rewrite_end(curr);
 }
 
 unsigned long mark_header(void)
 {
+#ifdef CONFIG_HOSTED
+	out_hold(1);
+#endif
 	return out_tell();
 }
@@ -40,7 +40,20 @@ struct header {
 #define H_SWITCHTAB	0x0018	/* switch jump table */
 #define H_ARGFRAME	0x0019	/* argument frame size info */
 
+/* H_SWITCH data: what the table will look like. The table is always sorted
+   and is in the same value, label format in each case */
+#define SWITCH_SEARCH	0x0001	/* enough cases to binary search */
+#define SWITCH_DENSE	0x0002	/* every value from first to last present */
+/* H_SWITCH is followed by SWITCH_INFO data records summarising the cases
+   so the backend can pick a method before it has seen them. They are the
+   lowest, second lowest and highest case as constants of the switch type
+   with the case number in val2 and the number of cases in snum. Unused
+   ones have case number 0 */
+#define SWITCH_INFO	3
+
 extern void header(unsigned htype, unsigned name, unsigned data);
 extern void footer(unsigned htype, unsigned name, unsigned data);
 extern void rewrite_header(unsigned long off, unsigned htype, unsigned name, unsigned data);
 extern unsigned long mark_header(void);
+extern unsigned long rewrite_start(unsigned long pos);
+extern void rewrite_end(unsigned long curr);
@@ -11,6 +11,55 @@
 
 #include "compiler.h"
 
+#ifdef CONFIG_HOSTED
+
+/*
+ *	Simple pool allocator for the growable tables. Nothing is ever
+ *	given back, we just carve up big blocks.
+ */
+#define POOL_BLOCK	16384
+
+static unsigned char *poolptr;
+static unsigned poolleft;
+
+void *pool_get(unsigned size)
+{
+    void *p;
+    /* Keep everything aligned for the worst case */
+    size = (size + sizeof(long) - 1) & ~(sizeof(long) - 1);
+    if (size > poolleft) {
+        unsigned n = size > POOL_BLOCK ? size : POOL_BLOCK;
+        poolptr = malloc(n);
+        if (poolptr == NULL)
+            fatal("out of memory");
+        poolleft = n;
+    }
+    p = poolptr;
+    poolptr += size;
+    poolleft -= size;
+    return p;
+}
+
+/* The index vectors are never freed so we just start a new block when
+   the current one fills up */
+static unsigned *idxptr;
+static unsigned idxleft;
+
+unsigned *idx_get(unsigned len)
+{
+    unsigned *p;
+    if (len > idxleft) {
+        idxleft = len > IDX_SIZE ? len : IDX_SIZE;
+        idxptr = pool_get(idxleft * sizeof(unsigned));
+    }
+    p = idxptr;
+    idxptr += len;
+    idxleft -= len;
+    return p;
+}
+
+#else
+
 static unsigned idxmem[IDX_SIZE];
 static unsigned *idxptr = idxmem;
 /*
@@ -27,6 +76,8 @@ unsigned *idx_get(unsigned len)
     return p;
 }
 
+#endif
+
 unsigned *idx_copy(unsigned *p, unsigned n)
 {
     unsigned *r = idx_get(n);
@@ -1,2 +1,5 @@
 extern unsigned *idx_get(unsigned len);
 extern unsigned *idx_copy(unsigned *from, unsigned len);
+#ifdef CONFIG_HOSTED
+extern void *pool_get(unsigned size);
+#endif
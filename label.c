@@ -4,6 +4,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include "compiler.h"
 
 #define L_DECLARED	0x8000
@@ -13,7 +14,13 @@ struct label {
     uint16_t line;
 };
 
+#ifdef CONFIG_HOSTED
+static struct label label_table[MAXLABEL];
+static struct label *labels = label_table;
+static unsigned maxlabel = MAXLABEL;
+#else
 struct label labels[MAXLABEL];
+#endif
 struct label *labelp;
 
 void init_labels(void)
@@ -23,8 +30,18 @@ void init_labels(void)
 
 static void new_label(unsigned n)
 {
+#ifdef CONFIG_HOSTED
+    if (labelp == &labels[maxlabel]) {
+        struct label *n = pool_get(2 * maxlabel * sizeof(struct label));
+        memcpy(n, labels, maxlabel * sizeof(struct label));
+        labels = n;
+        labelp = n + maxlabel;
+        maxlabel *= 2;
+    }
+#else
     if (labelp == &labels[MAXLABEL])
         fatal("too many goto labels");
+#endif
     labelp->name = n;
     labelp->line = line_num;
     labelp++;
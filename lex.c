@@ -39,6 +39,101 @@ static int in_byte(void)
 	return EOF;
 }
 
+#ifdef CONFIG_HOSTED
+
+/*
+ *	On a hosted build we keep the output in memory and write it out in
+ *	order, so the output can be a pipe to the next pass. The only things
+ *	that seek back are the function frame and switch headers, so while
+ *	one of those is held we keep everything after it (a function at a
+ *	time).
+ */
+
+static unsigned char *outbuf;
+static unsigned outsize;
+static unsigned outlen;		/* Bytes in the buffer */
+static unsigned outpos;		/* Where we are writing in the buffer */
+static unsigned long outbase;	/* Output offset of the buffer start */
+static unsigned outheld;
+
+static void out_room(unsigned n)
+{
+	if (outpos + n > outsize) {
+		outsize = 2 * (outpos + n);
+		if (outsize < 4096)
+			outsize = 4096;
+		outbuf = realloc(outbuf, outsize);
+		if (outbuf == NULL)
+			fatal("out of memory");
+	}
+}
+
+/* Write out everything we have */
+void out_write(void)
+{
+	if (outlen && write(1, outbuf, outlen) != outlen)
+		fatal("write error");
+	outbase += outlen;
+	outlen = 0;
+	outpos = 0;
+}
+
+/* Write out what we can */
+void out_flush(void)
+{
+	if (!outheld && outpos == outlen)
+		out_write();
+}
+
+/* Report the current position */
+unsigned long out_tell(void)
+{
+	return outbase + outpos;
+}
+
+/* Go to a given position from before. It must still be in memory */
+void out_seek(unsigned long pos)
+{
+	if (pos < outbase || pos > outbase + outlen)
+		fatal("seek error");
+	outpos = pos - outbase;
+}
+
+/* Stop or resume writing while we might come back to rewrite. Holds
+   nest as switch headers are rewritten within a function */
+void out_hold(unsigned on)
+{
+	if (on)
+		outheld++;
+	else
+		outheld--;
+	out_flush();
+}
+
+/* Add bytes at the current position */
+void out_byte(unsigned char c)
+{
+	out_room(1);
+	outbuf[outpos++] = c;
+	if (outpos > outlen)
+		outlen = outpos;
+	if (outlen >= 512)
+		out_flush();
+}
+
+void out_block(void *pv, unsigned len)
+{
+	out_room(len);
+	memcpy(outbuf + outpos, pv, len);
+	outpos += len;
+	if (outpos > outlen)
+		outlen = outpos;
+	if (outlen >= 512)
+		out_flush();
+}
+
+#else
+
 static unsigned char outbuf[128];
 static unsigned char *outptr = outbuf;
 static unsigned int outlen;
@@ -117,6 +212,8 @@ void out_block(void *pv, unsigned len)
 	}
 }
 
+#endif
+
 char filename[33];
 
 unsigned line_num;
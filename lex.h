@@ -21,5 +21,8 @@ extern void out_write(void);
 extern void out_flush(void);
 extern unsigned long out_tell(void);
 extern void out_seek(unsigned long pos);
+#ifdef CONFIG_HOSTED
+extern void out_hold(unsigned on);
+#endif
 extern void out_byte(unsigned char c);
 extern void out_block(void *pv, unsigned len);
@@ -7,6 +7,7 @@
 #include <stdlib.h>
 
 #include "compiler.h"
+#include "stats.h"
 
 FILE *debug;
 
@@ -65,5 +66,14 @@ int main(int argc, char *argv[])
 	/* No write out any uninitialized variables */
 	write_bss();
 	out_write();
+#ifdef DEBUG
+	if (debug)
+		fprintf(debug, "type compares %lu\n", type_compares);
+#endif
+#ifdef CONFIG_HOSTED
+	/* Report our counters if the driver is collecting statistics */
+	stats_printf("pass=cc1 nodes=%lu type_compares=%lu\n",
+		nodes_made, type_compares);
+#endif
 	return errors;
 }
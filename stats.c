@@ -0,0 +1,40 @@
+/*
+ *	The driver hands each pass the scratch file for cc --stats as
+ *	FCC_STATS_FD. Our input, output and diagnostics are 0-2 so a stray
+ *	variable naming one of those is ignored rather than corrupting them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#include "stats.h"
+
+#ifdef CONFIG_HOSTED
+
+int stats_open(void)
+{
+	char *p = getenv("FCC_STATS_FD");
+	int fd;
+
+	if (p == NULL)
+		return -1;
+	fd = atoi(p);
+	if (fd <= 2)
+		return -1;
+	return fd;
+}
+
+void stats_printf(const char *fmt, ...)
+{
+	int fd = stats_open();
+	va_list ap;
+
+	if (fd == -1)
+		return;
+	va_start(ap, fmt);
+	vdprintf(fd, fmt, ap);
+	va_end(ap);
+}
+
+#endif
@@ -0,0 +1,10 @@
+/*
+ *	Counters for cc --stats
+ */
+
+#ifdef CONFIG_HOSTED
+/* Where the driver wants our counters written, or -1 if it doesn't */
+extern int stats_open(void);
+/* Add a line to the report if the driver is collecting statistics */
+extern void stats_printf(const char *fmt, ...);
+#endif
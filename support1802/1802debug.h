@@ -80,10 +80,10 @@ const char *opnames[] = {
 	"cleanup",
 	"native",
 	"byte",
-	NULL,
-	NULL,
-	NULL,
-	NULL,
+	"switchbc",
+	"switchbuc",
+	"switchb",
+	"switchbu",
 	NULL,
 	NULL,
 	NULL,
@@ -222,8 +222,8 @@ const char *opnames[] = {
 	"r3dec2",
 	"r3drfpost",
 	"r3drfpre",
-	NULL,
-	NULL,
+	"switchbl",
+	"switchbul",
 	NULL,
 	NULL,
 	NULL,
@@ -174,3 +174,9 @@
 #define op_r3dec2          	0x01B8
 #define op_r3drfpost       	0x01BA
 #define op_r3drfpre        	0x01BC
+#define op_switchbc        	0x00A2
+#define op_switchbuc       	0x00A4
+#define op_switchbl        	0x01BE
+#define op_switchbul       	0x01C0
+#define op_switchb         	0x00A6
+#define op_switchbu        	0x00A8
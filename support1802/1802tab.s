@@ -80,10 +80,10 @@ byteop:	; Must be page aligned
 	.word op_cleanup
 	.word op_native
 	.word op_byte
-	.word op_invalid
-	.word op_invalid
-	.word op_invalid
-	.word op_invalid
+	.word op_switchbc
+	.word op_switchbuc
+	.word op_switchb
+	.word op_switchbu
 	.word op_invalid
 	.word op_invalid
 	.word op_invalid
@@ -222,8 +222,8 @@ byteop:	; Must be page aligned
 	.word op_r3dec2
 	.word op_r3drfpost
 	.word op_r3drfpre
-	.word op_invalid
-	.word op_invalid
+	.word op_switchbl
+	.word op_switchbul
 	.word op_invalid
 	.word op_invalid
 	.word op_invalid
@@ -0,0 +1,70 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchl, sorted by value
+;
+	.export __switchbul
+
+	.setcpu 6803
+
+__switchbul:
+	; X holds the switch table, hireg:D the value
+	std @tmp
+	stx @tmp4		; Table, for finding the default
+	ldd ,x			; Number of entries
+	inx
+	inx
+	stx @tmp1		; First entry
+	std @tmp2
+search:
+	; @tmp1 is the first entry, @tmp2 the number of entries
+	ldd @tmp2
+	beq default
+	; The middle entry is at @tmp1 + (@tmp2 / 2) * 6
+	lsrd
+	asld
+	std @tmp3
+	asld
+	addd @tmp3
+	addd @tmp1
+	std @tmp3
+	ldx @tmp3
+	; Compare the upper half then the lower
+	ldd ,x
+	subd @hireg
+	bcs higher
+	bne lower
+	ldd 2,x
+	subd @tmp
+	bcs higher
+	beq found
+lower:
+	; Search the count / 2 entries below
+	lsr @tmp2
+	ror @tmp2+1
+	bra search
+higher:
+	; Search the (count - 1) / 2 entries above
+	ldd @tmp3
+	addd #6
+	std @tmp1
+	ldd @tmp2
+	subd #1
+	lsrd
+	std @tmp2
+	bra search
+found:
+	ldx 4,x
+	jmp ,x
+default:
+	; The default label follows the last entry
+	ldx @tmp4
+	ldd ,x
+	asld
+	std @tmp3
+	asld
+	addd @tmp3
+	addd @tmp4
+	std @tmp3
+	ldx @tmp3
+	ldx 2,x
+	jmp ,x
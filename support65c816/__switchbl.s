@@ -0,0 +1,79 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchl, sorted by value. The top byte is compared
+;	with the sign flipped so signed values order as unsigned
+;
+	.65c816
+	.a16
+	.i16
+
+	.export __switchbl
+
+__switchbl:
+	; X holds the switch table hireg:A the value
+	sta @tmp	; value to find
+	lda @hireg
+	eor #0x8000
+	sta @hireg
+	lda 0,x
+	sta @tmp2	; length
+	inx
+	inx
+	stx @tmp3	; first entry
+	asl a
+	sta @sign
+	asl a
+	clc
+	adc @sign
+	clc
+	adc @tmp3
+	pha		; the default follows the last entry
+search:
+	; @tmp3 is the first entry, @tmp2 the number of entries
+	lda @tmp2
+	beq default
+	; The middle entry is at @tmp3 + (length / 2) * 6
+	and #0xFFFE
+	sta @sign
+	asl a
+	clc
+	adc @sign
+	clc
+	adc @tmp3
+	tax
+	; Compare the upper half then the lower
+	lda 2,x
+	eor #0x8000
+	cmp @hireg
+	bne decide
+	lda 0,x
+	cmp @tmp
+	beq gotswitch
+decide:
+	bcs lower
+	; Search the (length - 1) / 2 entries above
+	txa
+	clc
+	adc #6
+	sta @tmp3
+	lda @tmp2
+	dec a
+	lsr a
+	sta @tmp2
+	bra search
+lower:
+	; Search the length / 2 entries below
+	lsr @tmp2
+	bra search
+gotswitch:
+	lda 4,x
+	plx		; discard
+	dec a
+	pha
+	rts
+default:
+	plx
+	lda 0,x
+	dec a
+	pha
+	rts
@@ -0,0 +1,63 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switch, sorted by value
+;
+	.65c816
+	.a16
+	.i16
+
+	.export __switchbu
+
+__switchbu:
+	; X holds the switch table A the value
+	sta @tmp	; value to find
+	lda 0,x
+	sta @tmp2	; length
+	inx
+	inx
+	stx @tmp3	; first entry
+	asl a
+	asl a
+	clc
+	adc @tmp3
+	pha		; the default follows the last entry
+search:
+	; @tmp3 is the first entry, @tmp2 the number of entries
+	lda @tmp2
+	beq default
+	; The middle entry is at @tmp3 + (length / 2) * 4
+	and #0xFFFE
+	asl a
+	clc
+	adc @tmp3
+	tax
+	lda 0,x
+	cmp @tmp
+	beq gotswitch
+	bcs lower
+	; Search the (length - 1) / 2 entries above
+	txa
+	clc
+	adc #4
+	sta @tmp3
+	lda @tmp2
+	dec a
+	lsr a
+	sta @tmp2
+	bra search
+lower:
+	; Search the length / 2 entries below
+	lsr @tmp2
+	bra search
+gotswitch:
+	lda 2,x
+	plx		; discard
+	dec a
+	pha
+	rts
+default:
+	plx
+	lda 0,x
+	dec a
+	pha
+	rts
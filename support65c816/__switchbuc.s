@@ -0,0 +1,72 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchc, sorted by value
+;
+	.65c816
+	.a16
+	.i16
+
+	.export __switchbuc
+
+__switchbuc:
+	; X holds the switch table A the value
+	sep #0x20
+	sta @tmp	; value to find
+	rep #0x20
+	lda 0,x
+	sta @tmp2	; length
+	inx
+	inx
+	stx @tmp3	; first entry
+	sta @hireg
+	asl a
+	clc
+	adc @hireg
+	clc
+	adc @tmp3
+	pha		; the default follows the last entry
+search:
+	; @tmp3 is the first entry, @tmp2 the number of entries
+	lda @tmp2
+	beq default
+	; The middle entry is at @tmp3 + (length / 2) * 3
+	lsr a
+	sta @hireg
+	asl a
+	clc
+	adc @hireg
+	clc
+	adc @tmp3
+	tax
+	sep #0x20
+	lda 0,x
+	cmp @tmp
+	rep #0x20
+	beq gotswitch
+	bcs lower
+	; Search the (length - 1) / 2 entries above
+	inx
+	inx
+	inx
+	stx @tmp3
+	lda @tmp2
+	dec a
+	lsr a
+	sta @tmp2
+	bra search
+lower:
+	; Search the length / 2 entries below
+	lsr @tmp2
+	bra search
+gotswitch:
+	lda 1,x
+	plx		; discard
+	dec a
+	pha
+	rts
+default:
+	plx
+	lda 0,x
+	dec a
+	pha
+	rts
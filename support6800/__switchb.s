@@ -0,0 +1,89 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switch, sorted by value. Signed values are compared
+;	with the sign flipped so they order as unsigned
+;
+	.export __switchb
+
+__switchb:
+	; X holds the switch table, D the value
+	eora #0x80
+	staa @tmp
+	stab @tmp+1
+	stx @tmp4		; Table, for finding the default
+	ldaa ,x			; Number of entries
+	ldab 1,x
+	inx
+	inx
+	stx @tmp1		; First entry
+	staa @tmp2
+	stab @tmp2+1
+search:
+	; @tmp1 is the first entry, @tmp2 the number of entries
+	ldaa @tmp2
+	ldab @tmp2+1
+	bne probe
+	tsta
+	beq default
+probe:
+	; The middle entry is at @tmp1 + (@tmp2 / 2) * 4
+	lsra
+	rorb
+	aslb
+	rola
+	aslb
+	rola
+	addb @tmp1+1
+	adca @tmp1
+	staa @tmp3
+	stab @tmp3+1
+	ldx @tmp3
+	ldaa ,x
+	eora #0x80
+	ldab 1,x
+	subb @tmp+1
+	sbca @tmp
+	bcs higher
+	bne lower
+	tstb
+	beq found
+lower:
+	; Search the count / 2 entries below
+	lsr @tmp2
+	ror @tmp2+1
+	bra search
+higher:
+	; Search the (count - 1) / 2 entries above
+	inx
+	inx
+	inx
+	inx
+	stx @tmp1
+	ldaa @tmp2
+	ldab @tmp2+1
+	subb #1
+	sbca #0
+	lsra
+	rorb
+	staa @tmp2
+	stab @tmp2+1
+	bra search
+found:
+	ldx 2,x
+	jmp ,x
+default:
+	; The default label follows the last entry
+	ldx @tmp4
+	ldaa ,x
+	ldab 1,x
+	aslb
+	rola
+	aslb
+	rola
+	addb @tmp4+1
+	adca @tmp4
+	staa @tmp3
+	stab @tmp3+1
+	ldx @tmp3
+	ldx 2,x
+	jmp ,x
@@ -0,0 +1,83 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchc, sorted by value
+;
+	.export __switchbuc
+
+__switchbuc:
+	; X holds the switch table, B the value
+	stab @tmp
+	stx @tmp4		; Table, for finding the default
+	ldaa ,x			; Number of entries
+	ldab 1,x
+	inx
+	inx
+	stx @tmp1		; First entry
+	staa @tmp2
+	stab @tmp2+1
+search:
+	; @tmp1 is the first entry, @tmp2 the number of entries
+	ldaa @tmp2
+	ldab @tmp2+1
+	bne probe
+	tsta
+	beq default
+probe:
+	; The middle entry is at @tmp1 + (@tmp2 / 2) * 3
+	lsra
+	rorb
+	staa @tmp3
+	stab @tmp3+1
+	aslb
+	rola
+	addb @tmp3+1
+	adca @tmp3
+	addb @tmp1+1
+	adca @tmp1
+	staa @tmp3
+	stab @tmp3+1
+	ldx @tmp3
+	ldab ,x
+	cmpb @tmp
+	bcs higher
+	beq found
+	; Search the count / 2 entries below
+	lsr @tmp2
+	ror @tmp2+1
+	bra search
+higher:
+	; Search the (count - 1) / 2 entries above
+	inx
+	inx
+	inx
+	stx @tmp1
+	ldaa @tmp2
+	ldab @tmp2+1
+	subb #1
+	sbca #0
+	lsra
+	rorb
+	staa @tmp2
+	stab @tmp2+1
+	bra search
+found:
+	ldx 1,x
+	jmp ,x
+default:
+	; The default label follows the last entry
+	ldx @tmp4
+	ldaa ,x
+	ldab 1,x
+	staa @tmp3
+	stab @tmp3+1
+	aslb
+	rola
+	addb @tmp3+1
+	adca @tmp3
+	addb @tmp4+1
+	adca @tmp4
+	staa @tmp3
+	stab @tmp3+1
+	ldx @tmp3
+	ldx 2,x
+	jmp ,x
@@ -0,0 +1,104 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchl, sorted by value
+;
+	.export __switchbul
+
+__switchbul:
+	; X holds the switch table, hireg:D the value
+	staa @tmp
+	stab @tmp+1
+	stx @tmp4		; Table, for finding the default
+	ldaa ,x			; Number of entries
+	ldab 1,x
+	inx
+	inx
+	stx @tmp1		; First entry
+	staa @tmp2
+	stab @tmp2+1
+search:
+	; @tmp1 is the first entry, @tmp2 the number of entries
+	ldaa @tmp2
+	ldab @tmp2+1
+	bne probe
+	tsta
+	beq default
+probe:
+	; The middle entry is at @tmp1 + (@tmp2 / 2) * 6
+	lsra
+	rorb
+	aslb
+	rola
+	staa @tmp3
+	stab @tmp3+1
+	aslb
+	rola
+	addb @tmp3+1
+	adca @tmp3
+	addb @tmp1+1
+	adca @tmp1
+	staa @tmp3
+	stab @tmp3+1
+	ldx @tmp3
+	; Compare the upper half then the lower
+	ldaa ,x
+	ldab 1,x
+	subb @hireg+1
+	sbca @hireg
+	bcs higher
+	bne lower
+	tstb
+	bne lower
+	ldaa 2,x
+	ldab 3,x
+	subb @tmp+1
+	sbca @tmp
+	bcs higher
+	bne lower
+	tstb
+	beq found
+lower:
+	; Search the count / 2 entries below
+	lsr @tmp2
+	ror @tmp2+1
+	bra search
+higher:
+	; Search the (count - 1) / 2 entries above
+	ldab #6
+	addb @tmp3+1
+	ldaa #0
+	adca @tmp3
+	staa @tmp1
+	stab @tmp1+1
+	ldaa @tmp2
+	ldab @tmp2+1
+	subb #1
+	sbca #0
+	lsra
+	rorb
+	staa @tmp2
+	stab @tmp2+1
+	bra search
+found:
+	ldx 4,x
+	jmp ,x
+default:
+	; The default label follows the last entry
+	ldx @tmp4
+	ldaa ,x
+	ldab 1,x
+	aslb
+	rola
+	staa @tmp3
+	stab @tmp3+1
+	aslb
+	rola
+	addb @tmp3+1
+	adca @tmp3
+	addb @tmp4+1
+	adca @tmp4
+	staa @tmp3
+	stab @tmp3+1
+	ldx @tmp3
+	ldx 2,x
+	jmp ,x
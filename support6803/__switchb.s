@@ -0,0 +1,65 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switch, sorted by value. Signed values are compared
+;	with the sign flipped so they order as unsigned
+;
+	.export __switchb
+
+	.setcpu 6803
+
+__switchb:
+	; X holds the switch table, D the value
+	eora #0x80
+	std @tmp
+	stx @tmp4		; Table, for finding the default
+	ldd ,x			; Number of entries
+	inx
+	inx
+	stx @tmp1		; First entry
+	std @tmp2
+search:
+	; @tmp1 is the first entry, @tmp2 the number of entries
+	ldd @tmp2
+	beq default
+	; The middle entry is at @tmp1 + (@tmp2 / 2) * 4
+	lsrd
+	asld
+	asld
+	addd @tmp1
+	std @tmp3
+	ldx @tmp3
+	ldd ,x
+	eora #0x80
+	subd @tmp
+	bcs higher
+	beq found
+	; Search the count / 2 entries below
+	lsr @tmp2
+	ror @tmp2+1
+	bra search
+higher:
+	; Search the (count - 1) / 2 entries above
+	inx
+	inx
+	inx
+	inx
+	stx @tmp1
+	ldd @tmp2
+	subd #1
+	lsrd
+	std @tmp2
+	bra search
+found:
+	ldx 2,x
+	jmp ,x
+default:
+	; The default label follows the last entry
+	ldx @tmp4
+	ldd ,x
+	asld
+	asld
+	addd @tmp4
+	std @tmp3
+	ldx @tmp3
+	ldx 2,x
+	jmp ,x
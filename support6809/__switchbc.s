@@ -0,0 +1,55 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchc, sorted by value. Signed values are compared
+;	with the sign flipped so they order as unsigned
+;
+	.export __switchbc
+
+__switchbc:
+	; X holds the switch table, B the value
+	; We can afford to trash Y
+	eorb #0x80
+	pshs d			; Value to find
+	ldd ,x++		; Number of entries
+	pshs x,d		; First entry and number of entries
+search:
+	; X is the first entry, 0,s the number of entries
+	ldd ,s
+	beq default
+	; The middle entry is at X + (count / 2) * 3
+	lsra
+	rorb
+	leay d,x
+	leay d,y
+	leay d,y
+	ldb ,y
+	eorb #0x80
+	cmpb 5,s
+	beq found
+	bhi lower
+	; Search the (count - 1) / 2 entries above
+	leax 3,y
+	ldd ,s
+	subd #1
+	lsra
+	rorb
+	std ,s
+	bra search
+lower:
+	; Search the count / 2 entries below
+	lsr ,s
+	ror 1,s
+	bra search
+found:
+	ldx 1,y
+	leas 6,s
+	jmp ,x
+default:
+	; The default label follows the last entry
+	ldx 2,s
+	ldd -2,x
+	leax d,x
+	leax d,x
+	ldx d,x
+	leas 6,s
+	jmp ,x
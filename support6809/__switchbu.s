@@ -0,0 +1,56 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switch, sorted by value
+;
+	.export __switchbu
+
+__switchbu:
+	; X holds the switch table, D the value
+	; We can afford to trash Y
+	pshs d			; Value to find
+	ldd ,x++		; Number of entries
+	pshs x,d		; First entry and number of entries
+search:
+	; X is the first entry, 0,s the number of entries
+	ldd ,s
+	beq default
+	; The middle entry is at X + (count / 2) * 4
+	lsra
+	rorb
+	aslb
+	rola
+	aslb
+	rola
+	leay d,x
+	ldd ,y
+	cmpd 4,s
+	beq found
+	bhi lower
+	; Search the (count - 1) / 2 entries above
+	leax 4,y
+	ldd ,s
+	subd #1
+	lsra
+	rorb
+	std ,s
+	bra search
+lower:
+	; Search the count / 2 entries below
+	lsr ,s
+	ror 1,s
+	bra search
+found:
+	ldx 2,y
+	leas 6,s
+	jmp ,x
+default:
+	; The default label follows the last entry
+	ldx 2,s
+	ldd -2,x
+	aslb
+	rola
+	aslb
+	rola
+	ldx d,x
+	leas 6,s
+	jmp ,x
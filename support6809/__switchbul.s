@@ -0,0 +1,62 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchl, sorted by value
+;
+	.export __switchbul
+
+__switchbul:
+	; X holds the switch table, Y:D the value
+	pshs d			; Value to find
+	tfr y,d
+	pshs d
+	ldd ,x++		; Number of entries
+	pshs x,d		; First entry and number of entries
+search:
+	; X is the first entry, 0,s the number of entries
+	ldd ,s
+	beq default
+	; The middle entry is at X + (count / 2) * 6
+	lsra
+	rorb
+	aslb
+	rola
+	leay d,x
+	leay d,y
+	leay d,y
+	; Compare the upper half then the lower
+	ldd ,y
+	cmpd 4,s
+	bne decide
+	ldd 2,y
+	cmpd 6,s
+	beq found
+decide:
+	bhi lower
+	; Search the (count - 1) / 2 entries above
+	leax 6,y
+	ldd ,s
+	subd #1
+	lsra
+	rorb
+	std ,s
+	bra search
+lower:
+	; Search the count / 2 entries below
+	lsr ,s
+	ror 1,s
+	bra search
+found:
+	ldx 4,y
+	leas 8,s
+	jmp ,x
+default:
+	; The default label follows the last entry
+	ldx 2,s
+	ldd -2,x
+	aslb
+	rola
+	leax d,x
+	leax d,x
+	ldx d,x
+	leas 8,s
+	jmp ,x
@@ -47,7 +47,7 @@ nextbit:
 	shld	__tmp3
 	lhld	__tmp2+2
 	jnc	nocarry
-	inr	l		; we know l is even so this can't carry
+	inx	h		; carry into the upper half
 nocarry:
 	xchg
 	lhld	__tmp3+2
@@ -0,0 +1,104 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchc, sorted by value. Signed values are compared
+;	with the sign flipped so they order as unsigned
+;
+			.export __switchbc
+			.setcpu 8080
+			.code
+
+__switchbc:
+		push	b
+		mov	a,l
+		xri	0x80
+		mov	c,a
+
+		; DE points to the table in the format
+		; Length
+		; value.8, label
+		; default label
+		xchg
+		mov	e,m
+		inx	h
+		mov	d,m
+		inx	h
+		push	h		; First entry, for finding the default
+		; HL is the first entry, DE the number of entries
+search:
+		mov	a,d
+		ora	e
+		jz	default
+		push	h
+		push	d
+		; The middle entry is at HL + (DE / 2) * 3
+		mov	a,d
+		ora	a
+		rar
+		mov	d,a
+		mov	a,e
+		rar
+		mov	e,a
+		dad	d
+		dad	d
+		dad	d
+		mov	a,m
+		xri	0x80
+		cmp	c
+		jz	found
+		; Carry set if the entry is below the value
+		pop	d		; Count
+		jc	higher
+		; Search the count / 2 entries below
+		mov	a,d
+		ora	a
+		rar
+		mov	d,a
+		mov	a,e
+		rar
+		mov	e,a
+		pop	h
+		jmp	search
+higher:
+		; Search the (count - 1) / 2 entries above
+		dcx	d
+		mov	a,d
+		ora	a
+		rar
+		mov	d,a
+		mov	a,e
+		rar
+		mov	e,a
+		inx	h
+		inx	h
+		inx	h
+		inx	sp		; Drop the old base
+		inx	sp
+		jmp	search
+found:
+		pop	d		; Drop count, base and first entry
+		pop	d
+		pop	d
+		inx	h
+		jmp	match
+default:
+		; The default label follows the last entry
+		pop	h
+		dcx	h
+		mov	d,m
+		dcx	h
+		mov	e,m
+		inx	h
+		inx	h
+		mov	b,d
+		mov	c,e
+		xchg
+		dad	h
+		dad	b
+		dad	d
+match:
+		mov	e,m
+		inx	h
+		mov	d,m
+		xchg
+		pop	b
+		pchl
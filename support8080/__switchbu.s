@@ -0,0 +1,103 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switch, sorted by value
+;
+			.export __switchbu
+			.setcpu 8080
+			.code
+
+__switchbu:
+		push	b
+		mov	b,h
+		mov	c,l
+
+		; DE points to the table in the format
+		; Length
+		; value, label
+		; default label
+		xchg
+		mov	e,m
+		inx	h
+		mov	d,m
+		inx	h
+		push	h		; First entry, for finding the default
+		; HL is the first entry, DE the number of entries
+search:
+		mov	a,d
+		ora	e
+		jz	default
+		push	h
+		push	d
+		; The middle entry is at HL + (DE / 2) * 4
+		mov	a,e
+		ani	0xFE
+		mov	e,a
+		xchg
+		dad	h
+		dad	d
+		inx	h
+		mov	a,m
+		cmp	b
+		jnz	decided
+		dcx	h
+		mov	a,m
+		inx	h
+		cmp	c
+		jz	found
+decided:
+		; Carry set if the entry is below the value. HL points to
+		; the top byte of the entry
+		pop	d		; Count
+		jc	higher
+		; Search the count / 2 entries below
+		mov	a,d
+		ora	a
+		rar
+		mov	d,a
+		mov	a,e
+		rar
+		mov	e,a
+		pop	h
+		jmp	search
+higher:
+		; Search the (count - 1) / 2 entries above
+		dcx	d
+		mov	a,d
+		ora	a
+		rar
+		mov	d,a
+		mov	a,e
+		rar
+		mov	e,a
+		inx	h
+		inx	h
+		inx	h
+		inx	sp		; Drop the old base
+		inx	sp
+		jmp	search
+found:
+		pop	d		; Drop count, base and first entry
+		pop	d
+		pop	d
+		inx	h
+		jmp	match
+default:
+		; The default label follows the last entry
+		pop	h
+		dcx	h
+		mov	d,m
+		dcx	h
+		mov	e,m
+		inx	h
+		inx	h
+		xchg
+		dad	h
+		dad	h
+		dad	d
+match:
+		mov	e,m
+		inx	h
+		mov	d,m
+		xchg
+		pop	b
+		pchl
@@ -0,0 +1,148 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchl, sorted by value. The top byte is compared
+;	with the sign flipped so signed values order as unsigned
+;
+			.export __switchbl
+			.setcpu 8080
+			.code
+
+__switchbl:
+		push	b
+		mov	b,h
+		mov	c,l
+		lda	__hireg+1
+		xri	0x80
+		sta	__hireg+1
+
+		; DE points to the table in the format
+		; Length
+		; value.32, label.16
+		; default label
+		xchg
+		mov	e,m
+		inx	h
+		mov	d,m
+		inx	h
+		push	h		; First entry, for finding the default
+		; HL is the first entry, DE the number of entries
+search:
+		mov	a,d
+		ora	e
+		jz	default
+		push	h
+		push	d
+		; The middle entry is at HL + (DE / 2) * 6
+		mov	a,d
+		ora	a
+		rar
+		mov	d,a
+		mov	a,e
+		rar
+		mov	e,a
+		push	h
+		mov	h,d
+		mov	l,e
+		dad	h
+		dad	d
+		dad	h
+		pop	d
+		dad	d
+		; Compare from the top byte down with DE as the pointer and
+		; the upper half of the value in HL
+		xchg
+		lhld	__hireg
+		inx	d
+		inx	d
+		inx	d
+		ldax	d
+		xri	0x80
+		cmp	h
+		jnz	decide3
+		dcx	d
+		ldax	d
+		cmp	l
+		jnz	decide2
+		dcx	d
+		ldax	d
+		cmp	b
+		jnz	decide1
+		dcx	d
+		ldax	d
+		cmp	c
+		jz	found
+		jmp	decide0
+decide3:
+		dcx	d
+decide2:
+		dcx	d
+decide1:
+		dcx	d
+decide0:
+		; Carry set if the entry is below the value. DE is the entry
+		xchg
+		pop	d		; Count
+		jc	higher
+		; Search the count / 2 entries below
+		mov	a,d
+		ora	a
+		rar
+		mov	d,a
+		mov	a,e
+		rar
+		mov	e,a
+		pop	h
+		jmp	search
+higher:
+		; Search the (count - 1) / 2 entries above
+		dcx	d
+		mov	a,d
+		ora	a
+		rar
+		mov	d,a
+		mov	a,e
+		rar
+		mov	e,a
+		inx	h
+		inx	h
+		inx	h
+		inx	h
+		inx	h
+		inx	h
+		inx	sp		; Drop the old base
+		inx	sp
+		jmp	search
+found:
+		pop	h		; Drop count, base and first entry
+		pop	h
+		pop	h
+		xchg
+		inx	h
+		inx	h
+		inx	h
+		inx	h
+		jmp	match
+default:
+		; The default label follows the last entry
+		pop	h
+		dcx	h
+		mov	d,m
+		dcx	h
+		mov	e,m
+		inx	h
+		inx	h
+		push	h
+		mov	h,d
+		mov	l,e
+		dad	h
+		dad	d
+		dad	h
+		pop	d
+		dad	d
+match:
+		mov	e,m
+		inx	h
+		mov	d,m
+		xchg
+		pop	b
+		pchl
@@ -43,7 +43,7 @@ nextbit:
 		ld	(__tmp3),hl
 		ld	hl,(__tmp2+2)
 		jr	nc,nocarry
-		inc	l		; we know l is even so this can't carry
+		inc	hl		; carry into the upper half
 nocarry:
 		ex	de,hl
 		ld	hl,(__tmp3+2)
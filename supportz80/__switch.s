@@ -1,6 +1,6 @@
 ;
-;	Switch. We use the tables as is, nothing clever like
-;	binary searching yet
+;	Switch. We scan the table as is. Switches with more cases use
+;	__switchb and __switchj instead
 ;
 		.export __switch
 		.export __switchu
@@ -0,0 +1,91 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switch, sorted by value. Signed values are compared
+;	with the sign flipped so they order as unsigned
+;
+		.export __switchb
+		.code
+
+__switchb:
+		push	bc
+		ld	a,h
+		xor	0x80
+		ld	b,a
+		ld	c,l
+
+		; DE points to the table in the format
+		; Length
+		; value, label
+		; default label
+		ex	de,hl
+		ld	e,(hl)
+		inc	hl
+		ld	d,(hl)
+		inc	hl
+		; Stack the address of the default label
+		push	de
+		ex	de,hl
+		add	hl,hl
+		add	hl,hl
+		add	hl,de
+		ex	(sp),hl
+		ex	de,hl
+		; HL is the first entry, DE the number of entries
+search:
+		ld	a,d
+		or	e
+		jr	z,default
+		push	hl
+		push	de
+		; The middle entry is at HL + (DE / 2) * 4
+		ld	a,e
+		and	0xFE
+		ld	e,a
+		ex	de,hl
+		add	hl,hl
+		add	hl,de
+		ld	e,(hl)
+		inc	hl
+		ld	a,(hl)
+		xor	0x80
+		ld	d,a
+		inc	hl
+		ex	de,hl
+		; HL is the value, DE points to the label
+		or	a
+		sbc	hl,bc
+		jr	z,found
+		pop	hl		; Count
+		jr	c,higher
+		; Search the count / 2 entries below
+		srl	h
+		rr	l
+		ex	de,hl
+		pop	hl
+		jr	search
+higher:
+		; Search the (count - 1) / 2 entries above
+		dec	hl
+		srl	h
+		rr	l
+		inc	de
+		inc	de
+		ex	de,hl
+		inc	sp		; Drop the old base
+		inc	sp
+		jr	search
+found:
+		pop	hl		; Drop count, base and default
+		pop	hl
+		pop	hl
+		ex	de,hl
+		jr	match
+default:
+		pop	hl
+match:
+		ld	e,(hl)
+		inc	hl
+		ld	d,(hl)
+		ex	de,hl
+		pop	bc
+		jp	(hl)
@@ -0,0 +1,86 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchc, sorted by value. Signed values are compared
+;	with the sign flipped so they order as unsigned
+;
+		.export __switchbc
+		.code
+
+__switchbc:
+		push	bc
+		ld	a,l
+		xor	0x80
+		ld	c,a
+
+		; DE points to the table in the format
+		; Length
+		; value.8, label
+		; default label
+		ex	de,hl
+		ld	e,(hl)
+		inc	hl
+		ld	d,(hl)
+		inc	hl
+		; Stack the address of the default label
+		push	de
+		push	hl
+		ld	h,d
+		ld	l,e
+		add	hl,hl
+		add	hl,de
+		pop	de
+		add	hl,de
+		ex	(sp),hl
+		ex	de,hl
+		; HL is the first entry, DE the number of entries
+search:
+		ld	a,d
+		or	e
+		jr	z,default
+		push	hl
+		push	de
+		; The middle entry is at HL + (DE / 2) * 3
+		srl	d
+		rr	e
+		add	hl,de
+		add	hl,de
+		add	hl,de
+		ld	a,(hl)
+		xor	0x80
+		inc	hl
+		cp	c
+		jr	z,found
+		ex	de,hl
+		pop	hl		; Count
+		jr	c,higher
+		; Search the count / 2 entries below
+		srl	h
+		rr	l
+		ex	de,hl
+		pop	hl
+		jr	search
+higher:
+		; Search the (count - 1) / 2 entries above
+		dec	hl
+		srl	h
+		rr	l
+		inc	de
+		inc	de
+		ex	de,hl
+		inc	sp		; Drop the old base
+		inc	sp
+		jr	search
+found:
+		pop	de		; Drop count, base and default
+		pop	de
+		pop	de
+		jr	match
+default:
+		pop	hl
+match:
+		ld	e,(hl)
+		inc	hl
+		ld	d,(hl)
+		ex	de,hl
+		pop	bc
+		jp	(hl)
@@ -0,0 +1,116 @@
+;
+;	Switch by binary search of a sorted table. The table format is the
+;	same as for __switchl, sorted by value
+;
+		.export __switchbul
+		.code
+
+__switchbul:
+		push	bc
+		ld	b,h
+		ld	c,l
+
+		; DE points to the table in the format
+		; Length
+		; value.32, label.16
+		; default label
+		ex	de,hl
+		ld	e,(hl)
+		inc	hl
+		ld	d,(hl)
+		inc	hl
+		; Stack the address of the default label
+		push	de
+		push	hl
+		ld	h,d
+		ld	l,e
+		add	hl,hl
+		add	hl,de
+		add	hl,hl
+		pop	de
+		add	hl,de
+		ex	(sp),hl
+		ex	de,hl
+		; HL is the first entry, DE the number of entries
+search:
+		ld	a,d
+		or	e
+		jr	z,default
+		push	hl
+		push	de
+		; The middle entry is at HL + (DE / 2) * 6
+		srl	d
+		rr	e
+		push	hl
+		ld	h,d
+		ld	l,e
+		add	hl,hl
+		add	hl,de
+		add	hl,hl
+		pop	de
+		add	hl,de
+		ld	d,h
+		ld	e,l
+		; Compare from the top byte down
+		inc	hl
+		inc	hl
+		inc	hl
+		ld	a,(__hireg+1)
+		cp	(hl)
+		jr	nz,decide
+		dec	hl
+		ld	a,(__hireg)
+		cp	(hl)
+		jr	nz,decide
+		dec	hl
+		ld	a,b
+		cp	(hl)
+		jr	nz,decide
+		dec	hl
+		ld	a,c
+		cp	(hl)
+		jr	z,found
+decide:
+		; Carry if the key is below the value
+		pop	hl		; Count
+		jr	nc,higher
+		; Search the count / 2 entries below
+		srl	h
+		rr	l
+		ex	de,hl
+		pop	hl
+		jr	search
+higher:
+		; Search the (count - 1) / 2 entries above
+		dec	hl
+		srl	h
+		rr	l
+		ex	de,hl
+		ld	a,l
+		add	a,6
+		ld	l,a
+		jr	nc,nocarry
+		inc	h
+nocarry:
+		inc	sp		; Drop the old base
+		inc	sp
+		jr	search
+found:
+		pop	hl		; Drop count, base and default
+		pop	hl
+		pop	hl
+		ex	de,hl
+		inc	hl
+		inc	hl
+		inc	hl
+		inc	hl
+		jr	match
+default:
+		pop	hl
+match:
+		ld	e,(hl)
+		inc	hl
+		ld	d,(hl)
+		ex	de,hl
+		pop	bc
+		jp	(hl)
@@ -1,6 +1,6 @@
 ;
-;	Switch. We use the tables as is, nothing clever like
-;	binary searching yet
+;	Switch. We scan the table as is. Switches with more cases use
+;	__switchbc and __switchjc instead
 ;
 		.export __switchc
 		.export __switchcu
@@ -0,0 +1,54 @@
+;
+;	Switch on a dense table. The table format is the same as for
+;	__switch but has an entry for every value from the first to the last
+;	so we can index it directly
+;
+		.export __switchj
+		.code
+
+__switchj:
+		push	bc
+		; DE points to the table in the format
+		; Length
+		; value, label
+		; default label
+		ex	de,hl
+		ld	c,(hl)
+		inc	hl
+		ld	b,(hl)
+		inc	hl
+		; BC is the number of entries, HL the first entry
+		push	hl
+		ld	a,(hl)
+		inc	hl
+		ld	h,(hl)
+		ld	l,a
+		ex	de,hl
+		or	a
+		sbc	hl,de		; Index from the first value
+		or	a
+		sbc	hl,bc
+		jr	nc,default
+		add	hl,bc
+		add	hl,hl
+		add	hl,hl
+		pop	de
+		add	hl,de
+		inc	hl		; Move on to the label
+		inc	hl
+		jr	match
+default:
+		; The default label follows the entries
+		ld	h,b
+		ld	l,c
+		add	hl,hl
+		add	hl,hl
+		pop	de
+		add	hl,de
+match:
+		ld	e,(hl)
+		inc	hl
+		ld	d,(hl)
+		ex	de,hl
+		pop	bc
+		jp	(hl)
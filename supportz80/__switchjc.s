@@ -0,0 +1,52 @@
+;
+;	Switch on a dense table. The table format is the same as for
+;	__switchc but has an entry for every value from the first to the last
+;	so we can index it directly
+;
+		.export __switchjc
+		.code
+
+__switchjc:
+		push	bc
+		ld	c,l
+		; DE points to the table in the format
+		; Length
+		; value.8, label
+		; default label
+		ex	de,hl
+		ld	e,(hl)
+		inc	hl
+		ld	d,(hl)
+		inc	hl
+		; DE is the number of entries, HL the first entry
+		ld	a,c
+		sub	(hl)		; Index from the first value
+		ld	c,a
+		ld	b,0
+		ex	de,hl
+		or	a
+		sbc	hl,bc
+		jr	z,default
+		jr	c,default
+		ld	h,b
+		ld	l,c
+		add	hl,hl
+		add	hl,bc
+		add	hl,de
+		inc	hl		; Move on to the label
+		jr	match
+default:
+		; The default label follows the entries
+		add	hl,bc
+		ld	b,h
+		ld	c,l
+		add	hl,hl
+		add	hl,bc
+		add	hl,de
+match:
+		ld	e,(hl)
+		inc	hl
+		ld	d,(hl)
+		ex	de,hl
+		pop	bc
+		jp	(hl)
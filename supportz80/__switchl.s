@@ -1,6 +1,6 @@
 ;
-;	Switch. We use the tables as is, nothing clever like
-;	binary searching yet
+;	Switch. We scan the table as is. Switches with more cases use
+;	__switchbl instead
 ;
 		.export __switchl
 		.export __switchlu
@@ -1,40 +1,164 @@
+#include <stdlib.h>
+#include <string.h>
 #include "compiler.h"
 
 /* Will need typing for the largest integral type TODO */
-unsigned long switch_table[NUM_SWITCH];
-unsigned long *switch_next = switch_table;
+struct switch_case {
+    unsigned long value;
+    unsigned entry;
+};
+
+#ifdef CONFIG_HOSTED
+static struct switch_case switch_space[NUM_SWITCH];
+static struct switch_case *switch_table = switch_space;
+static unsigned switch_max = NUM_SWITCH;
+struct switch_case *switch_next = switch_space;
+#else
+struct switch_case switch_table[NUM_SWITCH];
+struct switch_case *switch_next = switch_table;
+#endif
+
+static int switch_order(const void *a, const void *b)
+{
+    const struct switch_case *x = a;
+    const struct switch_case *y = b;
+    if (x->value < y->value)
+        return -1;
+    return x->value > y->value;
+}
 
 /*
- *	When we finish a switch block off we write the table out. We could
- *	do things here like enble binary search but for now we don't and
- *	for some types it's tricky
- *	TODO;
+ *	The switch header and the summary of the cases that follows it. We
+ *	write a blank one when we start the switch and fill it in at the end
  */
-void switch_done(unsigned tag, unsigned long *oldptr, unsigned type)
+static void switch_header(unsigned tag, unsigned flags, unsigned type,
+                          struct switch_case *p, unsigned count,
+                          unsigned long flip)
 {
-    unsigned count = 0;
-    unsigned long *p = oldptr;
+    struct node *n;
+    unsigned i, j;
 
-    header(H_SWITCHTAB, tag, switch_next - oldptr);
-    /* Table */
+    header(H_SWITCH, tag, flags);
+    for (i = 0; i < SWITCH_INFO; i++) {
+        n = make_constant(0, type);
+        n->val2 = 0;
+        /* Lowest, second lowest then highest */
+        j = i == SWITCH_INFO - 1 ? count - 1 : i;
+        if (j < count) {
+            n->value = p[j].value ^ flip;
+            n->val2 = p[j].entry;
+        }
+        n->snum = count;
+        put_typed_data(n);
+        free_node(n);
+    }
+}
+
+unsigned long switch_start(unsigned tag)
+{
+    unsigned long pos = mark_header();
+    switch_header(tag, 0, CINT, NULL, 0, 0);
+    return pos;
+}
+
+/*
+ *	When we finish a switch block off we write the table out sorted by
+ *	value so that the backend can binary search it. If the values are
+ *	nearly contiguous we also fill the gaps with the default so the
+ *	backend can index it directly. The table format stays the same so a
+ *	plain linear scan still works. Then we go back and fill in the
+ *	header at pos with the SWITCH_ flags and case summary.
+ */
+void switch_done(unsigned tag, unsigned base, unsigned type, unsigned long pos)
+{
+    struct switch_case *oldptr = switch_table + base;
+    struct switch_case *p = oldptr;
+    unsigned count = switch_next - oldptr;
+    unsigned long mask = TARGET_LONG_MASK;
+    unsigned long flip = 0;
+    unsigned long v, span = 0;
+    unsigned flags = 0;
+
+    switch(type_sizeof(type)) {
+    case 1:
+        mask = TARGET_CHAR_MASK;
+        break;
+    case 2:
+        mask = TARGET_SHORT_MASK;
+        break;
+    }
+    /* Sort signed values as unsigned with the sign flipped */
+    if (!(type & UNSIGNED))
+        flip = (mask >> 1) + 1;
     while(p < switch_next) {
-        put_typed_constant(type, *p++);
-        put_typed_case(tag, ++count);
+        p->value = (p->value & mask) ^ flip;
+        p++;
+    }
+    if (count) {
+        qsort(oldptr, count, sizeof(struct switch_case), switch_order);
+        for (p = oldptr + 1; p < switch_next; p++)
+            if (p->value == p[-1].value)
+                error("duplicate case");
+        /* Without the + 1 so a full 32bit range cannot wrap to 0 */
+        span = switch_next[-1].value - oldptr->value;
+    }
+    if (count >= SWITCH_SEARCH_MIN)
+        flags |= SWITCH_SEARCH;
+    if (count >= SWITCH_DENSE_MIN && span < count + count / 4)
+        flags |= SWITCH_DENSE;
+
+    p = oldptr;
+    if (flags & SWITCH_DENSE) {
+        header(H_SWITCHTAB, tag, span + 1);
+        for (v = oldptr->value; p < switch_next; v++) {
+            put_typed_constant(type, v ^ flip);
+            if (p->value == v) {
+                put_typed_case(tag, p->entry);
+                p++;
+            } else
+                put_typed_case(tag, 0);
+        }
+    } else {
+        header(H_SWITCHTAB, tag, count);
+        while(p < switch_next) {
+            put_typed_constant(type, p->value ^ flip);
+            put_typed_case(tag, p->entry);
+            p++;
+        }
     }
     /* Default */
     put_typed_case(tag, 0);
     footer(H_SWITCHTAB, tag, 0);
+
+    pos = rewrite_start(pos);
+    switch_header(tag, flags, type, oldptr, count, flip);
+    rewrite_end(pos);
+
     switch_next = oldptr;
 }
 
-unsigned long *switch_alloc(void)
+/* Switches nest so we hand out the table offset rather than a pointer as
+   the table may move when it grows */
+unsigned switch_alloc(void)
 {
-    return switch_next;
+    return switch_next - switch_table;
 }
 
-void switch_add_node(unsigned long value)
+void switch_add_node(unsigned long value, unsigned entry)
 {
+#ifdef CONFIG_HOSTED
+    if (switch_next == &switch_table[switch_max]) {
+        struct switch_case *n = pool_get(2 * switch_max * sizeof(struct switch_case));
+        memcpy(n, switch_table, switch_max * sizeof(struct switch_case));
+        switch_table = n;
+        switch_next = n + switch_max;
+        switch_max *= 2;
+    }
+#else
     if (switch_next == &switch_table[NUM_SWITCH])
         fatal("switch table full");
-    *switch_next++ = value;
+#endif
+    switch_next->value = value;
+    switch_next->entry = entry;
+    switch_next++;
 }
@@ -1,6 +1,7 @@
-extern void switch_done(unsigned tag, unsigned long *oldptr, unsigned type);
-extern unsigned long *switch_alloc(void);
-extern void switch_add_node(unsigned long value);
+extern unsigned long switch_start(unsigned tag);
+extern void switch_done(unsigned tag, unsigned base, unsigned type, unsigned long pos);
+extern unsigned switch_alloc(void);
+extern void switch_add_node(unsigned long value, unsigned entry);
 
 
 
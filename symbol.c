@@ -14,7 +14,44 @@ static void symbol_bss(struct symbol *);
 
 struct symbol symtab[MAXSYM];
 struct symbol *last_sym = symtab - 1;
-struct symbol *local_top = symtab;
+/* The last slot kept when locals are dropped */
+#ifdef CONFIG_HOSTED
+struct symbol *local_top = symtab + TYPESYM - 1;
+static struct symbol *type_top = symtab;
+#else
+struct symbol *local_top = symtab - 1;
+#endif
+
+/* Named symbols are also kept on hash chains by name. Names are token
+   numbers handed out in order so the low bits spread them nicely. Each
+   chain is kept in descending symtab order so walking it gives the same
+   priority as walking the table backwards */
+#define NSYMHASH	64
+static struct symbol *symhash[NSYMHASH];
+
+#define SYMHASH(n)	(symhash + ((n) & (NSYMHASH - 1)))
+
+static unsigned hashed_name(unsigned name)
+{
+	return name != 0 && name != 0xFFFF;
+}
+
+static void hash_symbol(register struct symbol *s)
+{
+	register struct symbol **p = SYMHASH(s->name);
+	while (*p && *p > s)
+		p = &(*p)->chain;
+	s->chain = *p;
+	*p = s;
+}
+
+static void unhash_symbol(register struct symbol *s)
+{
+	register struct symbol **p = SYMHASH(s->name);
+	while (*p != s)
+		p = &(*p)->chain;
+	*p = s->chain;
+}
 
 struct symbol *symbol_ref(unsigned type)
 {
@@ -25,11 +62,11 @@ struct symbol *symbol_ref(unsigned type)
 /* Find a symbol in the normal name space */
 struct symbol *find_symbol(unsigned name, unsigned global)
 {
-	register struct symbol *s = last_sym;
+	register struct symbol *s = *SYMHASH(name);
 	struct symbol *gmatch = NULL;
 	/* Walk backwards so that the first local we find is highest priority
 	   by scope */
-	while (s >= symtab) {
+	while (s) {
 		if (s->name == name && s->infonext < S_TYPEDEF) {
 			if (s->infonext < S_STATIC) {
 				if (!global)
@@ -37,25 +74,25 @@ struct symbol *find_symbol(unsigned name, unsigned global)
 			} else	/* Still need to look for a local */
 				gmatch = s;
 		}
-		s--;
+		s = s->chain;
 	}
 	return gmatch;
 }
 
 struct symbol *find_symbol_by_class(unsigned name, unsigned class)
 {
-	register struct symbol *s = last_sym;
+	register struct symbol *s = *SYMHASH(name);
 	struct symbol *gmatch = NULL;
 	/* Walk backwards so that the first local we find is highest priority
 	   by scope */
-	while (s >= symtab) {
+	while (s) {
 		if (s->name == name && S_STORAGE(s->infonext) == class) {
 			if (s->infonext < S_STATIC)
 				return s;
 			else	/* Still need to look for a local */
 				gmatch = s;
 		}
-		s--;
+		s = s->chain;
 	}
 	return gmatch;
 }
@@ -67,6 +104,8 @@ void pop_local_symbols(struct symbol *top)
 		if (S_STORAGE(s->infonext) < S_STATIC) {
 			/* Write out any storage if needed */
 			symbol_bss(s);
+			if (hashed_name(s->name))
+				unhash_symbol(s);
 			s->infonext = S_FREE;
 			s->name = 0;
 		}
@@ -80,27 +119,49 @@ struct symbol *mark_local_symbols(void)
 	return local_top;
 }
 
+/* Fill in a free slot for a new symbol */
+static struct symbol *use_symbol(register struct symbol *s, unsigned name)
+{
+	if (last_sym < s)
+		last_sym = s;
+	s->name = name;
+	s->data.idx = 0;
+	if (hashed_name(name))
+		hash_symbol(s);
+	return s;
+}
+
 /* The symbols from 0 to local_top are a mix of kinds but as we have not
    discarded below that point are all full. Between that and last_sym there
    may be holes, above last_sym is free */
 struct symbol *alloc_symbol(unsigned name, unsigned local)
 {
-	register struct symbol *s = local_top;
-	while (s <= &symtab[MAXSYM]) {
+	register struct symbol *s = local_top + 1;
+	while (s < &symtab[MAXSYM]) {
 		if (s->infonext == S_FREE) {
 			if (local && local_top < s)
 				local_top = s;
-			if (last_sym < s)
-				last_sym = s;
-			s->name = name;
-			s->data.idx = 0;
-			return s;
+			return use_symbol(s, name);
 		}
 		s++;
 	}
 	fatal("too many symbols");
 }
 
+/* Slots for arrays, functions and structs, which types refer to by number.
+   These are never freed so on a hosted build they are handed out in order
+   from the part of the table kept for them */
+static struct symbol *alloc_type(unsigned name)
+{
+#ifdef CONFIG_HOSTED
+	if (type_top == symtab + TYPESYM)
+		fatal("too many types");
+	return use_symbol(type_top++, name);
+#else
+	return alloc_symbol(name, 0);
+#endif
+}
+
 /*
  *	Create or update a symbol. Warn about any symbol we are hiding.
  *	A symbol can be setup as C_ANY meaning "we've no idea yet" to hold
@@ -190,37 +251,68 @@ struct symbol *update_symbol_by_name(unsigned name, unsigned storage,
  *	Although it has a cost we really need to fold all the equivalently
  *	typed argument sets into a single instance to save memory.
  *
- *	TODO: we need to hash this, but differently to the usual symbol
- *	indexing as we care about the template pattern most
+ *	Prototype and array slots are hashed on the contents of their index
+ *	vector rather than their name. The chains run in symtab order so we
+ *	find the same (first) match the old table walk did.
  */
+#define NTYPEHASH	32
+static struct symbol *typehash[NTYPEHASH];
+
+unsigned long type_compares;
+
+static struct symbol **type_chain(unsigned st, register unsigned *idx)
+{
+	register unsigned n = *idx + 1;
+	register unsigned h = st >> 12;
+	while(n--)
+		h = (h << 3) + h + *idx++;
+	return typehash + (h & (NTYPEHASH - 1));
+}
+
 static struct symbol *do_type_match(unsigned st, unsigned rtype, unsigned *idx)
 {
-	register struct symbol *sym = symtab;
-	while(sym <= last_sym) {
+	register struct symbol **p = type_chain(st, idx);
+	register struct symbol *sym = *p;
+	while(sym) {
+		type_compares++;
 		if (S_STORAGE(sym->infonext) == st && sym->type == rtype && sym->data.idx == idx) {
 			return sym;
 		}
-		sym++;
+		sym = sym->chain;
 	}
-	sym = alloc_symbol(0xFFFF, 0);
+	sym = alloc_type(0xFFFF);
 	sym->infonext = st;
 	sym->data.idx = idx;
 	sym->type = rtype;
+	while(*p && *p < sym)
+		p = &(*p)->chain;
+	sym->chain = *p;
+	*p = sym;
 	return sym;
 }
 
 unsigned *sym_find_idx(unsigned storage, unsigned *idx, unsigned len)
 {
-	register struct symbol *sym = symtab;
+	register struct symbol *sym = *type_chain(storage, idx);
 	unsigned blen = len * sizeof(unsigned);
-	while (sym <= last_sym) {
+	while (sym) {
+		type_compares++;
 		if (S_STORAGE(sym->infonext) == storage && memcmp(sym->data.idx, idx, blen) == 0)
 			return sym->data.idx;
-		sym++;
+		sym = sym->chain;
 	}
 	return idx_copy(idx, len);
 }
 
+/* Types refer to their slot by number and only have room for 1024 */
+static unsigned type_slot(struct symbol *sym)
+{
+	unsigned n = sym - symtab;
+	if (n > 0x3FF)
+		fatal("too many types");
+	return n << 3;
+}
+
 unsigned func_return(unsigned n)
 {
 	if (!IS_FUNCTION(n))
@@ -239,7 +331,7 @@ unsigned make_function(unsigned type, unsigned *idx)
 {
 	/* Can we use the one we found (if we did) */
 	struct symbol *sym = do_type_match(S_FUNCDEF, type, idx);
-	return C_FUNCTION | ((sym - symtab) << 3);
+	return C_FUNCTION | type_slot(sym);
 }
 
 unsigned func_symbol_type(unsigned type, unsigned *idx)
@@ -247,7 +339,7 @@ unsigned func_symbol_type(unsigned type, unsigned *idx)
 	struct symbol *sym;
 	idx = sym_find_idx(S_FUNCDEF, idx, *idx + 1);
 	sym = do_type_match(S_FUNCDEF, type, idx);
-	return C_FUNCTION | ((sym - symtab) << 3);
+	return C_FUNCTION | type_slot(sym);
 }
 
 /*
@@ -269,7 +361,7 @@ unsigned array_dimension(unsigned type, unsigned depth)
 unsigned make_array(unsigned type, unsigned *idx)
 {
 	struct symbol *sym = do_type_match(S_ARRAY, type, idx);
-	return C_ARRAY | ((sym - symtab) << 3) | *idx;
+	return C_ARRAY | type_slot(sym) | *idx;
 }
 
 unsigned array_type(unsigned n)
@@ -317,19 +409,22 @@ unsigned array_compatible(unsigned t1, unsigned t2)
 
 static struct symbol *find_struct(unsigned name)
 {
-	struct symbol *sym = symtab;
+	struct symbol *sym;
+	struct symbol *match = NULL;
 	/* Anonymous structs are unique each time */
 	if (name == 0)
 		return 0;
-	while(sym <= last_sym) {
+	/* The chain runs downwards and we want the oldest definition */
+	sym = *SYMHASH(name);
+	while(sym) {
 		if (sym->name == name) {
 			unsigned st = S_STORAGE(sym->infonext);
 			if (st == S_STRUCT || st == S_UNION)
-				return sym;
+				match = sym;
 		}
-		sym++;
+		sym = sym->chain;
 	}
-	return NULL;
+	return match;
 }
 
 struct symbol *update_struct(unsigned name, unsigned t)
@@ -341,7 +436,7 @@ struct symbol *update_struct(unsigned name, unsigned t)
 		t = S_UNION;
 	sym = find_struct(name);
 	if (sym == NULL) {
-		sym = alloc_symbol(name, 0);	/* TODO scoping */
+		sym = alloc_type(name);	/* TODO scoping */
 		sym->infonext = t;
 		sym->data.idx = NULL;	/* Not yet known */
 	} else {
@@ -372,7 +467,7 @@ unsigned *struct_find_member(unsigned name, unsigned fname)
 
 unsigned type_of_struct(struct symbol *sym)
 {
-	return C_STRUCT|((sym - symtab) << 3);
+	return C_STRUCT | type_slot(sym);
 }
 
 /*
@@ -7,6 +7,7 @@ struct symbol
         unsigned *idx;		/* Index into object specific data */
         int offset;		/* Offset for locals */
     } data;
+    struct symbol *chain;	/* Next symbol with the same name hash */
 };
 
 #define INITIALIZED	0x0800
@@ -59,3 +60,5 @@ extern unsigned type_of_struct(struct symbol *sym);
 extern unsigned *struct_find_member(unsigned name, unsigned fname);
 
 extern void write_bss(void);
+
+extern unsigned long type_compares;
@@ -1,4 +1,8 @@
+#ifdef CONFIG_HOSTED
+#define MAXNAME		8192
+#else
 #define MAXNAME		1024
+#endif
 
 #define	NAMELEN		16	/* 15 usable due to _ lead on C names */
 
@@ -10,6 +10,7 @@ extern void step6502(void);
 extern void hookexternal(void (*loopexternal)(void));
 extern uint16_t getPC(void);
 extern uint64_t getclockticks(void);
+extern uint64_t clockticks6502, instructions;
 extern void waitstates(uint32_t n);
 
 //externally supplied functions
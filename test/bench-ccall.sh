@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+#	Compare the normal driver with the single process one
+#
+#	bench-ccall.sh [cpu] [cc] [cc-all] [repeats]
+#
+#	Compiles each of tests/*.c to assembler with both drivers, reports
+#	the average time per file and checks that the output matches.
+#
+CPU=${1:-z80}
+CC=${2:-/opt/fcc/bin/fcc}
+CCALL=${3:-/opt/fcc/bin/fcc-all}
+REPEAT=${4:-5}
+DIR=/tmp/bench-ccall.$$
+
+mkdir -p $DIR/cc $DIR/all || exit 1
+cp tests/*.c $DIR/cc
+cp tests/*.c $DIR/all
+FILES=$(ls tests/*.c | wc -l)
+
+# Run a driver over every file in a directory, printing microseconds
+run() {
+	start=$(date +%s%N)
+	n=0
+	while [ $n -lt $REPEAT ]
+	do
+		for i in $2/*.c
+		do
+			$1 -m$CPU -O2 -S $i -o ${i%.c}.s || exit 1
+		done
+		n=$((n + 1))
+	done
+	end=$(date +%s%N)
+	echo $(( (end - start) / 1000 / (FILES * REPEAT) ))
+}
+
+echo "$CPU: $FILES files, $REPEAT runs"
+echo "cc:     $(run $CC $DIR/cc) us/file"
+echo "cc-all: $(run $CCALL $DIR/all) us/file"
+for i in $DIR/cc/*.s
+do
+	cmp -s $i $DIR/all/$(basename $i) || echo "$(basename $i): output differs"
+done
+rm -rf $DIR
@@ -0,0 +1,72 @@
+#!/bin/sh
+#
+#	Compare two run-bench.sh results and flag regressions
+#
+#	bench-compare.sh old.csv new.csv [percent]
+#
+#	Lists every cpu/opt/bench whose cycles or text size grew by more than
+#	percent (default 1), or which used to pass and no longer does, and
+#	exits 1 if there were any. Improvements beyond the limit are listed
+#	as well but are not an error.
+#
+if [ $# -lt 2 ]; then
+	echo "$0: old.csv new.csv [percent]" >&2
+	exit 2
+fi
+
+awk -F, -v limit=${3:-1} '
+function change(o, n) {
+	if (o == "" || n == "" || o == 0)
+		return 0
+	return (n - o) * 100 / o
+}
+function report(what, key, o, n, c) {
+	printf "%-8s %-24s %-7s %10s -> %10s  %+.2f%%\n", what, key, w, o, n, c
+}
+FNR == 1 { next }
+{ key = $1 " " $2 " " $3 }
+NR == FNR {
+	status[key] = $4
+	cycles[key] = $5
+	text[key] = $7
+	next
+}
+{
+	if (!(key in status)) {
+		printf "%-8s %-24s\n", "NEW", key
+		next
+	}
+	seen[key] = 1
+	if (status[key] == "ok" && $4 != "ok") {
+		printf "%-8s %-24s %s\n", "BROKEN", key, $4
+		bad++
+		next
+	}
+	if (status[key] != "ok" && $4 == "ok")
+		printf "%-8s %-24s\n", "FIXED", key
+	if ($4 != "ok" || status[key] != "ok")
+		next
+	w = "cycles"
+	c = change(cycles[key], $5)
+	if (c > limit) {
+		report("WORSE", key, cycles[key], $5, c)
+		bad++
+	} else if (c < -limit)
+		report("BETTER", key, cycles[key], $5, c)
+	w = "text"
+	c = change(text[key], $7)
+	if (c > limit) {
+		report("WORSE", key, text[key], $7, c)
+		bad++
+	} else if (c < -limit)
+		report("BETTER", key, text[key], $7, c)
+}
+END {
+	for (key in status)
+		if (!(key in seen))
+			printf "%-8s %-24s\n", "MISSING", key
+	if (bad) {
+		printf "%d regressions\n", bad
+		exit 1
+	}
+}' "$1" "$2"
@@ -0,0 +1,38 @@
+#!/bin/sh
+#
+#	Benchmark the peephole optimiser on a large generated assembler file
+#
+#	bench-copt.sh [cpu] [copies] [old-copt]
+#
+#	Builds the unoptimised output of tests/*.c for the cpu, glues copies
+#	of it together and times copt over the result. If an older copt is
+#	given it is timed on the same input and the outputs are compared.
+#
+CPU=${1:-z80}
+COPIES=${2:-50}
+OLD=$3
+COPT=${COPT:-/opt/fcc/lib/copt}
+RULES=/opt/fcc/lib/rules.$CPU
+BIG=/tmp/bench-copt.$$.s
+
+for i in tests/*.c
+do
+	fcc -O0 -m$CPU -S $i -o /tmp/bench-copt.$$.1 || exit 1
+	cat /tmp/bench-copt.$$.1 >>/tmp/bench-copt.$$.0
+done
+n=0
+while [ $n -lt $COPIES ]
+do
+	cat /tmp/bench-copt.$$.0
+	n=$((n + 1))
+done >$BIG
+echo "$CPU: $(wc -l <$BIG) lines"
+
+echo "new:"
+time $COPT -S $RULES <$BIG >$BIG.new
+if [ -n "$OLD" ]; then
+	echo "old:"
+	time $OLD $RULES <$BIG >$BIG.old
+	cmp $BIG.old $BIG.new && echo "output identical"
+fi
+rm -f $BIG $BIG.new $BIG.old /tmp/bench-copt.$$.0 /tmp/bench-copt.$$.1
@@ -0,0 +1,117 @@
+/* CRC-16/CCITT and CRC-32 done bitwise and by table */
+
+static unsigned char buf[256];
+static unsigned crc16tab[256];
+static unsigned long crc32tab[256];
+
+static unsigned crc16_bit(unsigned crc, const unsigned char *p, unsigned n)
+{
+    unsigned i;
+    while (n--) {
+        crc ^= (unsigned)*p++ << 8;
+        for (i = 0; i < 8; i++) {
+            if (crc & 0x8000)
+                crc = (crc << 1) ^ 0x1021;
+            else
+                crc <<= 1;
+        }
+    }
+    return crc & 0xFFFF;
+}
+
+static void crc16_init(void)
+{
+    unsigned i, j, crc;
+    for (i = 0; i < 256; i++) {
+        crc = i << 8;
+        for (j = 0; j < 8; j++) {
+            if (crc & 0x8000)
+                crc = (crc << 1) ^ 0x1021;
+            else
+                crc <<= 1;
+        }
+        crc16tab[i] = crc & 0xFFFF;
+    }
+}
+
+static unsigned crc16_tab(unsigned crc, const unsigned char *p, unsigned n)
+{
+    while (n--)
+        crc = ((crc << 8) ^ crc16tab[((crc >> 8) ^ *p++) & 0xFF]) & 0xFFFF;
+    return crc;
+}
+
+static unsigned long crc32_bit(unsigned long crc, const unsigned char *p, unsigned n)
+{
+    unsigned i;
+    crc = ~crc & 0xFFFFFFFFUL;
+    while (n--) {
+        crc ^= *p++;
+        for (i = 0; i < 8; i++) {
+            if (crc & 1)
+                crc = (crc >> 1) ^ 0xEDB88320UL;
+            else
+                crc >>= 1;
+        }
+    }
+    return ~crc & 0xFFFFFFFFUL;
+}
+
+static void crc32_init(void)
+{
+    unsigned i, j;
+    unsigned long crc;
+    for (i = 0; i < 256; i++) {
+        crc = i;
+        for (j = 0; j < 8; j++) {
+            if (crc & 1)
+                crc = (crc >> 1) ^ 0xEDB88320UL;
+            else
+                crc >>= 1;
+        }
+        crc32tab[i] = crc;
+    }
+}
+
+static unsigned long crc32_tab(unsigned long crc, const unsigned char *p, unsigned n)
+{
+    crc = ~crc & 0xFFFFFFFFUL;
+    while (n--)
+        crc = crc32tab[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc & 0xFFFFFFFFUL;
+}
+
+int main(int argc, char *argv[])
+{
+    static const unsigned char check[] = "123456789";
+    unsigned i;
+    unsigned c16;
+    unsigned long c32;
+
+    if (crc16_bit(0xFFFF, check, 9) != 0x29B1)
+        return 1;
+    if (crc32_bit(0, check, 9) != 0xCBF43926UL)
+        return 2;
+    crc16_init();
+    crc32_init();
+    if (crc16_tab(0xFFFF, check, 9) != 0x29B1)
+        return 3;
+    if (crc32_tab(0, check, 9) != 0xCBF43926UL)
+        return 4;
+
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = i * 7 + 3;
+    c16 = 0xFFFF;
+    c32 = 0;
+    for (i = 0; i < 4; i++) {
+        c16 = crc16_tab(c16, buf, sizeof(buf));
+        c32 = crc32_tab(c32, buf, sizeof(buf));
+    }
+    if (crc16_bit(0xFFFF, buf, sizeof(buf)) != crc16_tab(0xFFFF, buf, sizeof(buf)))
+        return 5;
+    if (crc32_bit(0, buf, sizeof(buf)) != crc32_tab(0, buf, sizeof(buf)))
+        return 6;
+    if (c16 == 0 || c32 == 0)
+        return 7;
+    return 0;
+}
@@ -0,0 +1,271 @@
+/* Dhrystone 2.1 style procedures, records and strings */
+
+#define RUNS 100
+
+typedef enum { Ident_1, Ident_2, Ident_3, Ident_4, Ident_5 } Enumeration;
+
+struct record {
+    struct record *Ptr_Comp;
+    Enumeration Discr;
+    Enumeration Enum_Comp;
+    int Int_Comp;
+    char Str_Comp[31];
+};
+
+typedef struct record *Rec_Pointer;
+
+static struct record rec_1, rec_2;
+static Rec_Pointer Ptr_Glob;
+static Rec_Pointer Next_Ptr_Glob;
+static int Int_Glob;
+static int Bool_Glob;
+static char Ch_1_Glob;
+static char Ch_2_Glob;
+static int Arr_1_Glob[50];
+static int Arr_2_Glob[50][50];
+
+static void Proc_7(int Int_1_Par_Val, int Int_2_Par_Val, int *Int_Par_Ref);
+static void Proc_6(Enumeration Enum_Val_Par, Enumeration *Enum_Ref_Par);
+static Enumeration Func_1(char Ch_1_Par_Val, char Ch_2_Par_Val);
+
+static void str_copy(char *d, const char *s)
+{
+    while ((*d++ = *s++) != 0);
+}
+
+static int str_cmp(const char *a, const char *b)
+{
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a - *b;
+}
+
+/* Like the original we do struct assignment as a copy */
+static void rec_copy(Rec_Pointer d, Rec_Pointer s)
+{
+    char *dp = (char *)d;
+    char *sp = (char *)s;
+    unsigned n = sizeof(struct record);
+    while (n--)
+        *dp++ = *sp++;
+}
+
+static void Proc_3(Rec_Pointer *Ptr_Ref_Par)
+{
+    if (Ptr_Glob != 0)
+        *Ptr_Ref_Par = Ptr_Glob->Ptr_Comp;
+    Proc_7(10, Int_Glob, &Ptr_Glob->Int_Comp);
+}
+
+static void Proc_1(Rec_Pointer Ptr_Val_Par)
+{
+    Rec_Pointer Next_Record = Ptr_Val_Par->Ptr_Comp;
+
+    rec_copy(Ptr_Val_Par->Ptr_Comp, Ptr_Glob);
+    Ptr_Val_Par->Int_Comp = 5;
+    Next_Record->Int_Comp = Ptr_Val_Par->Int_Comp;
+    Next_Record->Ptr_Comp = Ptr_Val_Par->Ptr_Comp;
+    Proc_3(&Next_Record->Ptr_Comp);
+    if (Next_Record->Discr == Ident_1) {
+        Next_Record->Int_Comp = 6;
+        Proc_6(Ptr_Val_Par->Enum_Comp, &Next_Record->Enum_Comp);
+        Next_Record->Ptr_Comp = Ptr_Glob->Ptr_Comp;
+        Proc_7(Next_Record->Int_Comp, 10, &Next_Record->Int_Comp);
+    } else
+        rec_copy(Ptr_Val_Par, Ptr_Val_Par->Ptr_Comp);
+}
+
+static void Proc_2(int *Int_Par_Ref)
+{
+    int Int_Loc;
+    Enumeration Enum_Loc = Ident_2;
+
+    Int_Loc = *Int_Par_Ref + 10;
+    do {
+        if (Ch_1_Glob == 'A') {
+            Int_Loc -= 1;
+            *Int_Par_Ref = Int_Loc - Int_Glob;
+            Enum_Loc = Ident_1;
+        }
+    } while (Enum_Loc != Ident_1);
+}
+
+static void Proc_4(void)
+{
+    int Bool_Loc;
+
+    Bool_Loc = Ch_1_Glob == 'A';
+    Bool_Glob = Bool_Loc | Bool_Glob;
+    Ch_2_Glob = 'B';
+}
+
+static void Proc_5(void)
+{
+    Ch_1_Glob = 'A';
+    Bool_Glob = 0;
+}
+
+static int Func_3(Enumeration Enum_Par_Val)
+{
+    return Enum_Par_Val == Ident_3;
+}
+
+static void Proc_6(Enumeration Enum_Val_Par, Enumeration *Enum_Ref_Par)
+{
+    *Enum_Ref_Par = Enum_Val_Par;
+    if (!Func_3(Enum_Val_Par))
+        *Enum_Ref_Par = Ident_4;
+    switch (Enum_Val_Par) {
+    case Ident_1:
+        *Enum_Ref_Par = Ident_1;
+        break;
+    case Ident_2:
+        if (Int_Glob > 100)
+            *Enum_Ref_Par = Ident_1;
+        else
+            *Enum_Ref_Par = Ident_4;
+        break;
+    case Ident_3:
+        *Enum_Ref_Par = Ident_2;
+        break;
+    case Ident_4:
+        break;
+    case Ident_5:
+        *Enum_Ref_Par = Ident_3;
+        break;
+    }
+}
+
+static void Proc_7(int Int_1_Par_Val, int Int_2_Par_Val, int *Int_Par_Ref)
+{
+    int Int_Loc;
+
+    Int_Loc = Int_1_Par_Val + 2;
+    *Int_Par_Ref = Int_2_Par_Val + Int_Loc;
+}
+
+/* The 2D array is passed flat as we get pointers to arrays wrong */
+static void Proc_8(int *Arr_1_Par_Ref, int *Arr_2_Par_Ref,
+    int Int_1_Par_Val, int Int_2_Par_Val)
+{
+    int Int_Index;
+    int Int_Loc;
+
+    Int_Loc = Int_1_Par_Val + 5;
+    Arr_1_Par_Ref[Int_Loc] = Int_2_Par_Val;
+    Arr_1_Par_Ref[Int_Loc + 1] = Arr_1_Par_Ref[Int_Loc];
+    Arr_1_Par_Ref[Int_Loc + 30] = Int_Loc;
+    for (Int_Index = Int_Loc; Int_Index <= Int_Loc + 1; ++Int_Index)
+        Arr_2_Par_Ref[Int_Loc * 50 + Int_Index] = Int_Loc;
+    Arr_2_Par_Ref[Int_Loc * 50 + Int_Loc - 1] += 1;
+    Arr_2_Par_Ref[(Int_Loc + 20) * 50 + Int_Loc] = Arr_1_Par_Ref[Int_Loc];
+    Int_Glob = 5;
+}
+
+static Enumeration Func_1(char Ch_1_Par_Val, char Ch_2_Par_Val)
+{
+    char Ch_1_Loc;
+    char Ch_2_Loc;
+
+    Ch_1_Loc = Ch_1_Par_Val;
+    Ch_2_Loc = Ch_1_Loc;
+    if (Ch_2_Loc != Ch_2_Par_Val)
+        return Ident_1;
+    Ch_1_Glob = Ch_1_Loc;
+    return Ident_2;
+}
+
+static int Func_2(char *Str_1_Par_Ref, char *Str_2_Par_Ref)
+{
+    int Int_Loc;
+    char Ch_Loc = 0;
+
+    Int_Loc = 2;
+    while (Int_Loc <= 2)
+        if (Func_1(Str_1_Par_Ref[Int_Loc], Str_2_Par_Ref[Int_Loc + 1]) == Ident_1) {
+            Ch_Loc = 'A';
+            Int_Loc += 1;
+        }
+    if (Ch_Loc >= 'W' && Ch_Loc < 'Z')
+        Int_Loc = 7;
+    if (Ch_Loc == 'R')
+        return 1;
+    if (str_cmp(Str_1_Par_Ref, Str_2_Par_Ref) > 0) {
+        Int_Loc += 7;
+        Int_Glob = Int_Loc;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int Int_1_Loc = 0;
+    int Int_2_Loc = 0;
+    int Int_3_Loc = 0;
+    char Ch_Index;
+    Enumeration Enum_Loc = Ident_1;
+    char Str_1_Loc[31];
+    char Str_2_Loc[31];
+    int Run_Index;
+
+    Next_Ptr_Glob = &rec_2;
+    Ptr_Glob = &rec_1;
+    Ptr_Glob->Ptr_Comp = Next_Ptr_Glob;
+    Ptr_Glob->Discr = Ident_1;
+    Ptr_Glob->Enum_Comp = Ident_3;
+    Ptr_Glob->Int_Comp = 40;
+    str_copy(Ptr_Glob->Str_Comp, "DHRYSTONE PROGRAM, SOME STRING");
+    str_copy(Str_1_Loc, "DHRYSTONE PROGRAM, 1'ST STRING");
+    Arr_2_Glob[8][7] = 10;
+
+    for (Run_Index = 1; Run_Index <= RUNS; ++Run_Index) {
+        Proc_5();
+        Proc_4();
+        Int_1_Loc = 2;
+        Int_2_Loc = 3;
+        str_copy(Str_2_Loc, "DHRYSTONE PROGRAM, 2'ND STRING");
+        Enum_Loc = Ident_2;
+        Bool_Glob = !Func_2(Str_1_Loc, Str_2_Loc);
+        while (Int_1_Loc < Int_2_Loc) {
+            Int_3_Loc = 5 * Int_1_Loc - Int_2_Loc;
+            Proc_7(Int_1_Loc, Int_2_Loc, &Int_3_Loc);
+            Int_1_Loc += 1;
+        }
+        Proc_8(Arr_1_Glob, &Arr_2_Glob[0][0], Int_1_Loc, Int_3_Loc);
+        Proc_1(Ptr_Glob);
+        for (Ch_Index = 'A'; Ch_Index <= Ch_2_Glob; ++Ch_Index) {
+            if (Enum_Loc == Func_1(Ch_Index, 'C')) {
+                Proc_6(Ident_1, &Enum_Loc);
+                str_copy(Str_2_Loc, "DHRYSTONE PROGRAM, 3'RD STRING");
+                Int_2_Loc = Run_Index;
+                Int_Glob = Run_Index;
+            }
+        }
+        Int_2_Loc = Int_2_Loc * Int_1_Loc;
+        Int_1_Loc = Int_2_Loc / Int_3_Loc;
+        Int_2_Loc = 7 * (Int_2_Loc - Int_3_Loc) - Int_1_Loc;
+        Proc_2(&Int_1_Loc);
+    }
+
+    /* The values Dhrystone itself prints as should be */
+    if (Int_Glob != 5 || Bool_Glob != 1)
+        return 1;
+    if (Ch_1_Glob != 'A' || Ch_2_Glob != 'B')
+        return 2;
+    if (Arr_1_Glob[8] != 7 || Arr_2_Glob[8][7] != RUNS + 10)
+        return 3;
+    if (Ptr_Glob->Discr != Ident_1 || Ptr_Glob->Enum_Comp != Ident_3 ||
+        Ptr_Glob->Int_Comp != 17)
+        return 4;
+    if (Next_Ptr_Glob->Discr != Ident_1 || Next_Ptr_Glob->Enum_Comp != Ident_2 ||
+        Next_Ptr_Glob->Int_Comp != 18)
+        return 5;
+    if (Int_1_Loc != 5 || Int_2_Loc != 13 || Int_3_Loc != 7 || Enum_Loc != Ident_2)
+        return 6;
+    if (str_cmp(Str_2_Loc, "DHRYSTONE PROGRAM, 2'ND STRING"))
+        return 7;
+    return 0;
+}
@@ -0,0 +1,72 @@
+/* Single precision float: Newton's method, polynomials and integration */
+
+static float fsqrt(float x)
+{
+    float r = x;
+    unsigned i;
+    if (x <= 0.0f)
+        return 0.0f;
+    for (i = 0; i < 12; i++)
+        r = (r + x / r) * 0.5f;
+    return r;
+}
+
+/* exp(x) by its series, good enough for small x */
+static float fexp(float x)
+{
+    float t = 1.0f;
+    float s = 1.0f;
+    unsigned i;
+    for (i = 1; i < 12; i++) {
+        t = t * x / (float)i;
+        s += t;
+    }
+    return s;
+}
+
+static int near(float a, float b)
+{
+    float d = a - b;
+    if (d < 0.0f)
+        d = -d;
+    return d < 0.001f * (b < 0.0f ? -b : b) + 0.0001f;
+}
+
+/* Simpson's rule over x*x from 0 to 3 */
+static float simpson(unsigned n)
+{
+    float h = 3.0f / (float)n;
+    float s = 0.0f;
+    float x;
+    unsigned i;
+    for (i = 0; i <= n; i++) {
+        x = h * (float)i;
+        if (i == 0 || i == n)
+            s += x * x;
+        else if (i & 1)
+            s += 4.0f * x * x;
+        else
+            s += 2.0f * x * x;
+    }
+    return s * h / 3.0f;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned i;
+    float sum = 0.0f;
+
+    for (i = 1; i <= 50; i++)
+        sum += fsqrt((float)i);
+    if (!near(sum, 239.03580f))
+        return 1;
+    if (!near(fsqrt(2.0f), 1.4142136f))
+        return 2;
+    if (!near(fexp(1.0f), 2.7182818f))
+        return 3;
+    if (!near(fexp(-0.5f), 0.60653066f))
+        return 4;
+    if (!near(simpson(60), 9.0f))
+        return 5;
+    return 0;
+}
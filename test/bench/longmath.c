@@ -0,0 +1,71 @@
+/* 32bit integer arithmetic: multiply, divide, shifts and compares */
+
+static unsigned long seed = 1;
+
+static unsigned long rnd(void)
+{
+    seed = (seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    return seed;
+}
+
+static unsigned long gcd(unsigned long a, unsigned long b)
+{
+    unsigned long t;
+    while (b) {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Bit at a time square root */
+static unsigned long isqrt(unsigned long n)
+{
+    unsigned long r = 0;
+    unsigned long b = 1UL << 30;
+
+    while (b > n)
+        b >>= 2;
+    while (b) {
+        if (n >= r + b) {
+            n -= r + b;
+            r = (r >> 1) + b;
+        } else
+            r >>= 1;
+        b >>= 2;
+    }
+    return r;
+}
+
+static long sdiv(long a, long b)
+{
+    return a / b + a % b;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned i;
+    unsigned long sum = 0;
+    unsigned long x, y;
+    long s = 0;
+
+    for (i = 0; i < 40; i++) {
+        x = rnd() >> 8;
+        y = (rnd() >> 16) | 1;
+        sum += gcd(x, y);
+        sum ^= x / y;
+        sum += isqrt(x);
+        s += sdiv((long)x - 0x400000L, (long)(y & 0xFFF) - 0x800L);
+        sum = (sum << 3 | sum >> 29) & 0xFFFFFFFFUL;
+    }
+    if (isqrt(1000000UL) != 1000 || isqrt(4294967295UL) != 65535UL)
+        return 1;
+    if (gcd(1071UL, 462UL) != 21)
+        return 2;
+    if (sum != 0x7A4056ABUL)
+        return 3;
+    if (s != 9353L)
+        return 4;
+    return 0;
+}
@@ -0,0 +1,25 @@
+/* The classic BYTE sieve of Eratosthenes */
+
+#define SIZE 8190
+
+static char flags[SIZE + 1];
+
+int main(int argc, char *argv[])
+{
+    unsigned i, k, prime, count;
+
+    count = 0;
+    for (i = 0; i <= SIZE; i++)
+        flags[i] = 1;
+    for (i = 0; i <= SIZE; i++) {
+        if (flags[i]) {
+            prime = i + i + 3;
+            for (k = i + prime; k <= SIZE; k += prime)
+                flags[k] = 0;
+            count++;
+        }
+    }
+    if (count != 1899)
+        return 1;
+    return 0;
+}
@@ -0,0 +1,121 @@
+/* Insertion sort, shell sort and quicksort of pseudo random data */
+
+#define N 200
+
+static int data[N];
+static int work[N];
+static unsigned seed;
+
+static unsigned rnd(void)
+{
+    seed = seed * 25173 + 13849;
+    return seed;
+}
+
+static void fill(void)
+{
+    unsigned i;
+    seed = 1;
+    for (i = 0; i < N; i++)
+        data[i] = rnd() & 0x7FFF;
+}
+
+static void copy(void)
+{
+    int *s = data;
+    int *d = work;
+    unsigned n = N;
+    while (n--)
+        *d++ = *s++;
+}
+
+static void insertion(int *a, unsigned n)
+{
+    unsigned i, j;
+    int t;
+    for (i = 1; i < n; i++) {
+        t = a[i];
+        j = i;
+        while (j > 0 && a[j - 1] > t) {
+            a[j] = a[j - 1];
+            j--;
+        }
+        a[j] = t;
+    }
+}
+
+static void shell(int *a, unsigned n)
+{
+    unsigned gap, i, j;
+    int t;
+    for (gap = n / 2; gap > 0; gap /= 2) {
+        for (i = gap; i < n; i++) {
+            t = a[i];
+            for (j = i; j >= gap && a[j - gap] > t; j -= gap)
+                a[j] = a[j - gap];
+            a[j] = t;
+        }
+    }
+}
+
+static void quick(int *a, int lo, int hi)
+{
+    int i, j, p, t;
+    while (lo < hi) {
+        p = a[(lo + hi) >> 1];
+        i = lo;
+        j = hi;
+        while (i <= j) {
+            while (a[i] < p)
+                i++;
+            while (a[j] > p)
+                j--;
+            if (i <= j) {
+                t = a[i];
+                a[i] = a[j];
+                a[j] = t;
+                i++;
+                j--;
+            }
+        }
+        /* Recurse on the smaller part to bound the stack */
+        if (j - lo < hi - i) {
+            quick(a, lo, j);
+            lo = i;
+        } else {
+            quick(a, i, hi);
+            hi = j;
+        }
+    }
+}
+
+static unsigned check(int *a, unsigned n)
+{
+    unsigned i;
+    unsigned sum = 0;
+    for (i = 1; i < n; i++)
+        if (a[i - 1] > a[i])
+            return 0;
+    for (i = 0; i < n; i++)
+        sum += a[i] ^ i;
+    return sum;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned s1, s2, s3;
+
+    fill();
+    copy();
+    insertion(work, N);
+    s1 = check(work, N);
+    copy();
+    shell(work, N);
+    s2 = check(work, N);
+    copy();
+    quick(work, 0, N - 1);
+    s3 = check(work, N);
+    if (s1 == 0 || s1 != s2 || s1 != s3)
+        return 1;
+    return 0;
+}
@@ -0,0 +1,229 @@
+/* Switch driven state machines: a tokenizer and a little byte code VM */
+
+static const char text[] =
+    "int main(void) { x = 42 + y1 * (z - 7); /* note */ return x >= 10; }\n"
+    "while (n != 0) { s = s + n; n = n - 1; } // done\n"
+    "if (a < b && c > d || !e) f(0x1F, 'q', \"str\");\n";
+
+enum { S_START, S_IDENT, S_NUMBER, S_OP, S_SLASH, S_COMMENT, S_STAR,
+       S_LINE, S_QUOTE, S_STRING };
+
+static unsigned counts[8];
+
+static unsigned class(char c)
+{
+    switch (c) {
+    case ' ': case '\t': case '\n':
+        return 0;
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        return 1;
+    case '/':
+        return 3;
+    case '*':
+        return 4;
+    case '\'': case '"':
+        return 5;
+    case '_':
+        return 2;
+    default:
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+            return 2;
+        return 6;
+    }
+}
+
+static void tokenize(const char *p)
+{
+    unsigned state = S_START;
+    char quote = 0;
+
+    while (*p) {
+        char c = *p;
+        unsigned k = class(c);
+        switch (state) {
+        case S_START:
+            switch (k) {
+            case 0:
+                p++;
+                break;
+            case 1:
+                state = S_NUMBER;
+                break;
+            case 2:
+                state = S_IDENT;
+                break;
+            case 3:
+                state = S_SLASH;
+                p++;
+                break;
+            case 5:
+                quote = c;
+                state = S_QUOTE;
+                p++;
+                break;
+            default:
+                state = S_OP;
+                break;
+            }
+            break;
+        case S_IDENT:
+            if (k == 1 || k == 2)
+                p++;
+            else {
+                counts[0]++;
+                state = S_START;
+            }
+            break;
+        case S_NUMBER:
+            if (k == 1 || k == 2)
+                p++;
+            else {
+                counts[1]++;
+                state = S_START;
+            }
+            break;
+        case S_OP:
+            counts[2]++;
+            p++;
+            state = S_START;
+            break;
+        case S_SLASH:
+            if (c == '*') {
+                state = S_COMMENT;
+                p++;
+            } else if (c == '/') {
+                state = S_LINE;
+                p++;
+            } else {
+                counts[2]++;
+                state = S_START;
+            }
+            break;
+        case S_COMMENT:
+            if (c == '*')
+                state = S_STAR;
+            p++;
+            break;
+        case S_STAR:
+            if (c == '/') {
+                counts[3]++;
+                state = S_START;
+            } else if (c != '*')
+                state = S_COMMENT;
+            p++;
+            break;
+        case S_LINE:
+            if (c == '\n') {
+                counts[3]++;
+                state = S_START;
+            }
+            p++;
+            break;
+        case S_QUOTE:
+        case S_STRING:
+            if (c == quote) {
+                counts[4]++;
+                state = S_START;
+            }
+            p++;
+            break;
+        }
+    }
+}
+
+enum { OP_HALT, OP_PUSH, OP_LOAD, OP_STORE, OP_ADD, OP_SUB, OP_MUL,
+       OP_DUP, OP_JZ, OP_JMP, OP_LT, OP_SWAP, OP_DROP, OP_INC };
+
+/* sum = 0; for (i = 0; i < 100; i++) sum += i * 3; */
+static const unsigned char code[] = {
+    OP_PUSH, 0, OP_STORE, 0,
+    OP_PUSH, 0, OP_STORE, 1,
+    OP_LOAD, 1, OP_PUSH, 100, OP_LT, OP_JZ, 32,
+    OP_LOAD, 0, OP_LOAD, 1, OP_PUSH, 3, OP_MUL, OP_ADD, OP_STORE, 0,
+    OP_LOAD, 1, OP_INC, OP_STORE, 1, OP_JMP, 8,
+    OP_HALT
+};
+
+static int run(const unsigned char *pc)
+{
+    const unsigned char *base = pc;
+    int stack[16];
+    int var[4];
+    int *sp = stack;
+    int t;
+
+    while (1) {
+        switch (*pc++) {
+        case OP_HALT:
+            return var[0];
+        case OP_PUSH:
+            *sp++ = *pc++;
+            break;
+        case OP_LOAD:
+            *sp++ = var[*pc++];
+            break;
+        case OP_STORE:
+            var[*pc++] = *--sp;
+            break;
+        case OP_ADD:
+            sp--;
+            sp[-1] += *sp;
+            break;
+        case OP_SUB:
+            sp--;
+            sp[-1] -= *sp;
+            break;
+        case OP_MUL:
+            sp--;
+            sp[-1] *= *sp;
+            break;
+        case OP_DUP:
+            *sp = sp[-1];
+            sp++;
+            break;
+        case OP_JZ:
+            if (*--sp == 0)
+                pc = base + *pc;
+            else
+                pc++;
+            break;
+        case OP_JMP:
+            pc = base + *pc;
+            break;
+        case OP_LT:
+            sp--;
+            sp[-1] = sp[-1] < *sp;
+            break;
+        case OP_SWAP:
+            t = sp[-1];
+            sp[-1] = sp[-2];
+            sp[-2] = t;
+            break;
+        case OP_DROP:
+            sp--;
+            break;
+        case OP_INC:
+            sp[-1]++;
+            break;
+        default:
+            return -1;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned i;
+
+    for (i = 0; i < 10; i++)
+        tokenize(text);
+    if (counts[0] != 10 * 22 || counts[1] != 10 * 6)
+        return 1;
+    if (counts[2] != 10 * 40 || counts[3] != 10 * 2 || counts[4] != 10 * 2)
+        return 2;
+    for (i = 0; i < 10; i++)
+        if (run(code) != 14850)
+            return 3;
+    return 0;
+}
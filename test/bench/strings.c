@@ -0,0 +1,123 @@
+/* String routines of the kind found in any C library */
+
+static char buf[128];
+static char tmp[128];
+
+static const char *words[] = {
+    "the", "quick", "brown", "fox", "jumps", "over", "the", "lazy", "dog",
+    "pack", "my", "box", "with", "five", "dozen", "liquor", "jugs"
+};
+
+#define LOOPS 5
+#define NWORDS (sizeof(words) / sizeof(words[0]))
+
+static unsigned slen(const char *s)
+{
+    const char *p = s;
+    while (*p)
+        p++;
+    return p - s;
+}
+
+static char *scpy(char *d, const char *s)
+{
+    char *r = d;
+    while ((*d++ = *s++) != 0);
+    return r;
+}
+
+static char *scat(char *d, const char *s)
+{
+    scpy(d + slen(d), s);
+    return d;
+}
+
+static int scmp(const char *a, const char *b)
+{
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *(const unsigned char *)a - *(const unsigned char *)b;
+}
+
+static const char *schr(const char *s, int c)
+{
+    while (*s) {
+        if (*s == c)
+            return s;
+        s++;
+    }
+    return 0;
+}
+
+static const char *sstr(const char *s, const char *w)
+{
+    unsigned n = slen(w);
+    while (*s) {
+        unsigned i = 0;
+        while (i < n && s[i] == w[i])
+            i++;
+        if (i == n)
+            return s;
+        s++;
+    }
+    return 0;
+}
+
+static void srev(char *s)
+{
+    char *e = s + slen(s) - 1;
+    while (s < e) {
+        char c = *s;
+        *s++ = *e;
+        *e-- = c;
+    }
+}
+
+static void supper(char *s)
+{
+    while (*s) {
+        if (*s >= 'a' && *s <= 'z')
+            *s -= 32;
+        s++;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned i, n;
+    unsigned total = 0;
+    unsigned found = 0;
+    int order = 0;
+
+    for (n = 0; n < LOOPS; n++) {
+        *buf = 0;
+        for (i = 0; i < NWORDS; i++) {
+            scat(buf, words[i]);
+            scat(buf, " ");
+        }
+        total += slen(buf);
+        for (i = 0; i < NWORDS; i++) {
+            if (sstr(buf, words[i]))
+                found++;
+            if (scmp(words[i], words[(i + 1) % NWORDS]) < 0)
+                order++;
+        }
+        scpy(tmp, buf);
+        srev(tmp);
+        supper(tmp);
+        if (schr(tmp, 'q') || !schr(tmp, 'Q'))
+            return 1;
+        srev(tmp);
+        if (scmp(tmp, buf) >= 0)
+            return 2;
+    }
+    if (total != LOOPS * 84)
+        return 3;
+    if (found != LOOPS * NWORDS)
+        return 4;
+    if (order != LOOPS * 8)
+        return 5;
+    return 0;
+}
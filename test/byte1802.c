@@ -6,6 +6,7 @@
 #include <fcntl.h>
 #include "../support1802/1802ops.h"
 #include "../support1802/1802debug.h"
+#include "profile.h"
 
 /*
  *	We operate big endian because the 1805 forces the issue for later
@@ -19,19 +20,29 @@ static uint8_t mem[65536];
 static uint16_t sp;
 unsigned debug;
 
+/* This is a byte code engine so there are no cycles as such. Count the
+   memory bytes moved instead as that is where the 1802 spends its time */
+static unsigned long long mem_bytes;
+static unsigned long long ops;
+static unsigned counting;
+static unsigned profiling;
+
 static void mwc(uint16_t addr, uint8_t c)
 {
+	mem_bytes++;
 	mem[addr] = c;
 }
 
 static void mw(uint16_t addr, unsigned c)
 {
+	mem_bytes += 2;
 	mem[addr] = c >> 8;
 	mem[addr + 1] = c;
 }
 
 static void mwl(uint16_t addr, uint32_t c)
 {
+	mem_bytes += 4;
 	mem[addr] = c >> 24;
 	mem[addr + 1] = c >> 16;
 	mem[addr + 2] = c >> 8;
@@ -40,11 +51,13 @@ static void mwl(uint16_t addr, uint32_t c)
 
 static uint8_t mrc(uint16_t addr)
 {
+	mem_bytes++;
 	return mem[addr];
 }
 
 static uint16_t mr(uint16_t addr)
 {
+	mem_bytes += 2;
 	return (mem[addr] << 8)| mem[addr + 1];
 }
 
@@ -155,6 +168,42 @@ static uint16_t do_switchl(uint16_t pc, uint32_t l)
 	return mr(addr);
 }
 
+static uint32_t switch_value(uint16_t addr, unsigned size)
+{
+	if (size == 1)
+		return mrc(addr);
+	if (size == 2)
+		return mr(addr);
+	return mrl(addr);
+}
+
+/* The same tables sorted by value for a binary search. Signed values are
+   compared with the top bit flipped so they order as unsigned */
+static uint16_t do_switchb(uint16_t pc, uint32_t v, unsigned size, uint32_t flip)
+{
+	unsigned base = mr(pc) + 2;
+	unsigned count = mr(base - 2);
+	unsigned len = count;
+	unsigned addr;
+	uint32_t e;
+
+	v ^= flip;
+	while(len) {
+		addr = base + (len / 2) * (size + 2);
+		e = switch_value(addr, size) ^ flip;
+		if (e == v)
+			return mr(addr + size);
+		if (e > v)
+			len /= 2;
+		else {
+			base = addr + size + 2;
+			len = (len - 1) / 2;
+		}
+	}
+	/* The default follows the last entry */
+	return mr(mr(pc) + 2 + count * (size + 2));
+}
+
 static int16_t sexb(uint8_t r)
 {
 	if (r & 0x80)
@@ -174,8 +223,12 @@ unsigned execute(unsigned initpc, unsigned initsp)
 	sp = initsp;
 
 	while(1) {
-		uint16_t op = mrc(pc) + shift;
+		uint16_t op;
 
+		if (profiling)
+			profile_step(pc, mem_bytes);
+		op = mrc(pc) + shift;
+		ops++;
 		if (debug) {
 			const char *s = opnames[op >> 1];
 			if (s == NULL)
@@ -470,6 +523,30 @@ unsigned execute(unsigned initpc, unsigned initsp)
 			shift = 0;
 			pc = do_switch(pc, ac);
 			break;
+		case op_switchbc:
+			shift = 0;
+			pc = do_switchb(pc, ac & 0xFF, 1, 0x80);
+			break;
+		case op_switchbuc:
+			shift = 0;
+			pc = do_switchb(pc, ac & 0xFF, 1, 0);
+			break;
+		case op_switchbl:
+			shift = 0;
+			pc = do_switchb(pc, ac, 4, 0x80000000UL);
+			break;
+		case op_switchbul:
+			shift = 0;
+			pc = do_switchb(pc, ac, 4, 0);
+			break;
+		case op_switchb:
+			shift = 0;
+			pc = do_switchb(pc, ac & 0xFFFF, 2, 0x8000);
+			break;
+		case op_switchbu:
+			shift = 0;
+			pc = do_switchb(pc, ac & 0xFFFF, 2, 0);
+			break;
 		case op_cceqf:
 		case op_cceql:
 			ac = !!(popl() == ac);
@@ -774,19 +851,38 @@ unsigned execute(unsigned initpc, unsigned initsp)
 	}
 }
 
+static void report(void)
+{
+    if (profiling)
+        profile_end(mem_bytes);
+    if (counting)
+        fprintf(stderr, "cycles %llu instructions %llu\n", mem_bytes, ops);
+}
+
 int main(int argc, char *argv[])
 {
     int fd;
 
-    if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+    while (argc > 1 && *argv[1] == '-') {
+        if (strcmp(argv[1], "-d") == 0)
+            debug = 1;
+        else if (strcmp(argv[1], "-c") == 0)
+            counting = 1;
+        else if (strcmp(argv[1], "-p") == 0)
+            profiling = 1;
+        else
+            break;
         argv++;
         argc--;
-        debug = 1;
     }
     if (argc != 3) {
-        fprintf(stderr, "byte1802: test map.\n");
+        fprintf(stderr, "byte1802: [-c] [-d] [-p] test map.\n");
         exit(1);
     }
+    if (profiling)
+        profile_init(argv[2], argv[1]);
+    if (counting || profiling)
+        atexit(report);
     fd = open(argv[1], O_RDONLY);
     if (fd == -1) {
         perror(argv[1]);
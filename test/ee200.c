@@ -21,6 +21,7 @@
 #include <string.h>
 
 #include "ee200.h"
+#include "profile.h"
 
 static uint8_t cpu_ipl = 0;	/* IPL 0-15 */
 static uint8_t cpu_mmu = 0;	/* MMU tag 0-7 */
@@ -1524,9 +1525,15 @@ void ee200_init(void)
 #include <unistd.h>
 #include <fcntl.h>
 static uint8_t mem[0xE000];
+/* No timing model, so we count bus cycles instead */
+static unsigned long long bus_cycles;
+static unsigned long long instructions;
+static unsigned counting;
+static unsigned profiling;
 
 uint8_t mem_read8(uint16_t addr)
 {
+	bus_cycles++;
 	if (addr < sizeof(mem))
 		return mem[addr];
 	else
@@ -1543,6 +1550,7 @@ uint8_t mem_read8_debug(uint16_t addr)
 
 void mem_write8(uint16_t addr, uint8_t val)
 {
+	bus_cycles++;
 	if (addr == 0xFFFF) {
 		if (val)
 			printf("%d\n", val);
@@ -1552,20 +1560,39 @@ void mem_write8(uint16_t addr, uint8_t val)
 		mem[addr] = val;
 }
 
+static void report(void)
+{
+	if (profiling)
+		profile_end(bus_cycles);
+	if (counting)
+		fprintf(stderr, "cycles %llu instructions %llu\n", bus_cycles, instructions);
+}
+
 int main(int argc, char * argv[])
 {
 	int fd;
 	unsigned debug = 0;
 
-	if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+	while (argc > 1 && *argv[1] == '-') {
+		if (strcmp(argv[1], "-d") == 0)
+			debug = 1;
+		else if (strcmp(argv[1], "-c") == 0)
+			counting = 1;
+		else if (strcmp(argv[1], "-p") == 0)
+			profiling = 1;
+		else
+			break;
 		argv++;
 		argc--;
-		debug = 1;
 	}
 	if (argc != 3) {
-		fprintf(stderr, "ee200: test map.\n");
+		fprintf(stderr, "ee200: [-c] [-d] [-p] test map.\n");
 		exit(1);
 	}
+	if (profiling)
+		profile_init(argv[2], argv[1]);
+	if (counting || profiling)
+		atexit(report);
 	fd = open(argv[1], O_RDONLY);
 	if (fd == -1) {
 		perror(argv[1]);
@@ -1581,7 +1608,11 @@ int main(int argc, char * argv[])
 
 	set_pc_debug(0x0100);
 
-	while (1)
+	while (1) {
+		if (profiling)
+			profile_step(pc, bus_cycles);
 		ee200_execute_one(debug);
+		instructions++;
+	}
 	return 0;
 }
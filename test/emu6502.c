@@ -12,8 +12,11 @@
 #include <fcntl.h>
 
 #include "6502.h"
+#include "profile.h"
 
 static uint8_t ram[65536];
+static unsigned counting;
+static unsigned profiling;
 
 uint8_t read6502(uint16_t addr)
 {
@@ -45,18 +48,44 @@ void write6502(uint16_t addr, uint8_t val)
     }
 }
 
+/* Called after each instruction */
+static void profile_hook(void)
+{
+    profile_step(getPC(), clockticks6502);
+}
+
+static void report(void)
+{
+    if (profiling)
+        profile_end(clockticks6502);
+    if (counting)
+        fprintf(stderr, "cycles %llu instructions %llu\n",
+            (unsigned long long)clockticks6502, (unsigned long long)instructions);
+}
+
 int main(int argc, char *argv[])
 {
     int fd;
-    if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+    while (argc > 1 && *argv[1] == '-') {
+        if (strcmp(argv[1], "-d") == 0)
+            log_6502 = 1;
+        else if (strcmp(argv[1], "-c") == 0)
+            counting = 1;
+        else if (strcmp(argv[1], "-p") == 0)
+            profiling = 1;
+        else
+            break;
         argv++;
         argc--;
-        log_6502 = 1;
     }
     if (argc != 3) {
-        fprintf(stderr, "emu6502: test map.\n");
+        fprintf(stderr, "emu6502: [-c] [-d] [-p] test map.\n");
         exit(1);
     }
+    if (profiling)
+        profile_init(argv[2], argv[1]);
+    if (counting || profiling)
+        atexit(report);
     fd = open(argv[1], O_RDONLY);
     if (fd == -1) {
         perror(argv[1]);
@@ -77,6 +106,8 @@ int main(int argc, char *argv[])
     disassembler_init(argv[2]);
     init6502();
     reset6502();
+    if (profiling)
+        hookexternal(profile_hook);
 
     while(1)
         exec6502(100000);
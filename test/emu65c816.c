@@ -13,8 +13,12 @@
 
 #include <lib65816/cpu.h>
 #include <lib65816/cpuevent.h>
+#include "profile.h"
 
 static uint8_t ram[65536];
+static unsigned counting;
+static unsigned profiling;
+static uint64_t instructions;
 
 uint8_t read65c816(uint32_t addr, uint8_t mode)
 {
@@ -53,23 +57,46 @@ void wdm(void)
 {
 }
 
+/* With an update period of one we are called before each instruction */
 void system_process(void)
 {
+    instructions++;
+    if (profiling)
+        profile_step(PC.W.PC, cpu_cycle_count);
 }
 
+static void report(void)
+{
+    if (profiling)
+        profile_end(cpu_cycle_count);
+    if (counting)
+        fprintf(stderr, "cycles %llu instructions %llu\n",
+            (unsigned long long)cpu_cycle_count, (unsigned long long)instructions);
+}
 
 int main(int argc, char *argv[])
 {
     int fd;
-    if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+    while (argc > 1 && *argv[1] == '-') {
+        if (strcmp(argv[1], "-d") == 0)
+            CPU_setTrace(1);
+        else if (strcmp(argv[1], "-c") == 0)
+            counting = 1;
+        else if (strcmp(argv[1], "-p") == 0)
+            profiling = 1;
+        else
+            break;
         argv++;
         argc--;
-        CPU_setTrace(1);
     }
     if (argc != 3) {
-        fprintf(stderr, "emu65c816: test map.\n");
+        fprintf(stderr, "emu65c816: [-c] [-d] [-p] test map.\n");
         exit(1);
     }
+    if (profiling)
+        profile_init(argv[2], argv[1]);
+    if (counting || profiling)
+        atexit(report);
     fd = open(argv[1], O_RDONLY);
     if (fd == -1) {
         perror(argv[1]);
@@ -88,7 +115,7 @@ int main(int argc, char *argv[])
     ram[0xFFFD] = 0x02;
 
     CPUEvent_initialize();
-    CPU_setUpdatePeriod(100000);
+    CPU_setUpdatePeriod(counting || profiling ? 1 : 100000);
     CPU_reset();
     CPU_run();
 }
@@ -5,10 +5,15 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include "6800.h"
+#include "profile.h"
 
 static uint8_t ram[65536];
 
 struct m6800 cpu;
+static unsigned counting;
+static unsigned profiling;
+static unsigned long long cycles;
+static unsigned long long instructions;
 
 void m6800_sci_change(struct m6800 *cpu)
 {
@@ -112,21 +117,40 @@ void m6800_write(struct m6800 *cpu, uint16_t addr, uint8_t val)
 	}
 }
 
+static void report(void)
+{
+	if (profiling)
+		profile_end(cycles);
+	if (counting)
+		fprintf(stderr, "cycles %llu instructions %llu\n", cycles, instructions);
+}
+
 /* TODO: CPU setting option */
 int main(int argc, char *argv[])
 {
 	int fd;
 	unsigned debug = 0;
 
-	if (argc == 5 && strcmp(argv[1], "-d") == 0) {
-		debug = 1;
+	while (argc > 1 && *argv[1] == '-') {
+		if (strcmp(argv[1], "-d") == 0)
+			debug = 1;
+		else if (strcmp(argv[1], "-c") == 0)
+			counting = 1;
+		else if (strcmp(argv[1], "-p") == 0)
+			profiling = 1;
+		else
+			break;
 		argv++;
 		argc--;
 	}
 	if (argc != 4) {
-		fprintf(stderr, "emu6800: cpu test map.\n");
+		fprintf(stderr, "emu6800: [-c] [-d] [-p] cpu test map.\n");
 		exit(1);
 	}
+	if (profiling)
+		profile_init(argv[3], argv[2]);
+	if (counting || profiling)
+		atexit(report);
 	fd = open(argv[2], O_RDONLY);
 	if (fd == -1) {
 		perror(argv[2]);
@@ -159,8 +183,12 @@ int main(int argc, char *argv[])
 		m68hc11a_reset(&cpu, 0, 0, NULL, NULL);
 		if (debug)
 			cpu.debug = 1;
-		while(1)
-			m68hc11_execute(&cpu);
+		while(1) {
+			if (profiling)
+				profile_step(cpu.pc, cycles);
+			cycles += m68hc11_execute(&cpu);
+			instructions++;
+		}
 		break;
 	default:
 		fprintf(stderr, "Unknown cpu type '%s'\n", argv[1]);
@@ -169,6 +197,10 @@ int main(int argc, char *argv[])
 	if (debug)
 		cpu.debug = 1;
 
-	while (1)
-		m6800_execute(&cpu);
+	while (1) {
+		if (profiling)
+			profile_step(cpu.pc, cycles);
+		cycles += m6800_execute(&cpu);
+		instructions++;
+	}
 }
@@ -11,9 +11,14 @@
 
 #include "d6809.h"
 #include "e6809.h"
+#include "profile.h"
 
 static uint8_t ram[65536];
 int log_6809 = 0;
+static unsigned counting;
+static unsigned profiling;
+static unsigned long long cycles;
+static unsigned long long instructions;
 
 unsigned char e6809_read8(unsigned addr)
 {
@@ -85,6 +90,9 @@ void e6809_instruction(unsigned pc)
 {
 	char buf[80];
 	struct reg6809 *r = e6809_get_regs();
+	instructions++;
+	if (profiling)
+		profile_step(pc, cycles);
 	if (log_6809) {
 		d6809_disassemble(buf, pc & 0xFFFF);
 		fprintf(stderr, "%04X: %-16.16s | ", pc & 0xFFFF, buf);
@@ -92,19 +100,38 @@ void e6809_instruction(unsigned pc)
 	}
 }
 
+static void report(void)
+{
+	if (profiling)
+		profile_end(cycles);
+	if (counting)
+		fprintf(stderr, "cycles %llu instructions %llu\n", cycles, instructions);
+}
+
 int main(int argc, char *argv[])
 {
 	int fd;
 
-	if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+	while (argc > 1 && *argv[1] == '-') {
+		if (strcmp(argv[1], "-d") == 0)
+			log_6809 = 1;
+		else if (strcmp(argv[1], "-c") == 0)
+			counting = 1;
+		else if (strcmp(argv[1], "-p") == 0)
+			profiling = 1;
+		else
+			break;
 		argv++;
 		argc--;
-		log_6809 = 1;
 	}
 	if (argc != 3) {
-		fprintf(stderr, "emu6809: test map.\n");
+		fprintf(stderr, "emu6809: [-c] [-d] [-p] test map.\n");
 		exit(1);
 	}
+	if (profiling)
+		profile_init(argv[2], argv[1]);
+	if (counting || profiling)
+		atexit(report);
 	fd = open(argv[1], O_RDONLY);
 	if (fd == -1) {
 		perror(argv[1]);
@@ -123,6 +150,6 @@ int main(int argc, char *argv[])
 
 	e6809_reset(log_6809);
 	while (1)
-		e6809_sstep(0, 0);
+		cycles += e6809_sstep(0, 0);
 	return 0;
 }
@@ -10,8 +10,13 @@
 #include <fcntl.h>
 
 #include "intel_8085_emulator.h"
+#include "profile.h"
 
 static uint8_t ram[65536];
+static unsigned counting;
+static unsigned profiling;
+static uint64_t cycles;
+static uint64_t instructions;
 
 uint8_t i8085_read(uint16_t addr)
 {
@@ -62,18 +67,38 @@ void i8085_set_output(int value)
 {
 }
 
+static void report(void)
+{
+    if (profiling)
+        profile_end(cycles);
+    if (counting)
+        fprintf(stderr, "cycles %llu instructions %llu\n",
+            (unsigned long long)cycles, (unsigned long long)instructions);
+}
+
 int main(int argc, char *argv[])
 {
     int fd;
-    if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+    while (argc > 1 && *argv[1] == '-') {
+        if (strcmp(argv[1], "-d") == 0)
+            i8085_log = stderr;
+        else if (strcmp(argv[1], "-c") == 0)
+            counting = 1;
+        else if (strcmp(argv[1], "-p") == 0)
+            profiling = 1;
+        else
+            break;
         argv++;
         argc--;
-        i8085_log = stderr;
     }
     if (argc != 3) {
-        fprintf(stderr, "emu85: test map.\n");
+        fprintf(stderr, "emu85: [-c] [-d] [-p] test map.\n");
         exit(1);
     }
+    if (profiling)
+        profile_init(argv[2], argv[1]);
+    if (counting || profiling)
+        atexit(report);
     fd = open(argv[1], O_RDONLY);
     if (fd == -1) {
         perror(argv[1]);
@@ -87,6 +112,14 @@ int main(int argc, char *argv[])
     close(fd);
     i8085_load_symbols(argv[2]);
     i8085_reset(0);
+    /* Asked for one cycle the core runs exactly one instruction and
+       returns minus the overrun. The exiting instruction is not timed */
+    while(counting || profiling) {
+        if (profiling)
+            profile_step(i8085_read_reg16(PC), cycles);
+        instructions++;
+        cycles += 1 - i8085_exec(1);
+    }
     while(1)
         i8085_exec(100000);
 }
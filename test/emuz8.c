@@ -12,8 +12,13 @@
 #include <fcntl.h>
 
 #include "z8.h"
+#include "profile.h"
 
 static uint8_t ram[65536];
+static struct z8 *cpu;
+static unsigned counting;
+static unsigned profiling;
+static uint64_t instructions;
 
 uint8_t z8_read_data(struct z8 *cpu, uint16_t addr)
 {
@@ -68,21 +73,43 @@ void z8_write_code(struct z8 *cpu, uint16_t addr, uint8_t val)
     ram[addr] = val;
 }
 
+/* The core keeps a running total of cycles */
+static void report(void)
+{
+    if (cpu == NULL)
+        return;
+    if (profiling)
+        profile_end(cpu->cycles);
+    if (counting)
+        fprintf(stderr, "cycles %llu instructions %llu\n",
+            (unsigned long long)cpu->cycles, (unsigned long long)instructions);
+}
+
 int main(int argc, char *argv[])
 {
-    struct z8 *cpu;
     unsigned log = 0;
     int fd;
 
-    if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+    while (argc > 1 && *argv[1] == '-') {
+        if (strcmp(argv[1], "-d") == 0)
+            log = 1;
+        else if (strcmp(argv[1], "-c") == 0)
+            counting = 1;
+        else if (strcmp(argv[1], "-p") == 0)
+            profiling = 1;
+        else
+            break;
         argv++;
         argc--;
-        log = 1;
     }
     if (argc != 3) {
-        fprintf(stderr, "emuz8: test map.\n");
+        fprintf(stderr, "emuz8: [-c] [-d] [-p] test map.\n");
         exit(1);
     }
+    if (profiling)
+        profile_init(argv[2], argv[1]);
+    if (counting || profiling)
+        atexit(report);
     fd = open(argv[1], O_RDONLY);
     if (fd == -1) {
         perror(argv[1]);
@@ -99,6 +126,10 @@ int main(int argc, char *argv[])
     cpu = z8_create();
     z8_reset(cpu);
     z8_set_trace(cpu, log);
-    while(1)
+    while(1) {
+        if (profiling)
+            profile_step(cpu->pc, cpu->cycles);
         z8_execute(cpu);
+        instructions++;
+    }
 }
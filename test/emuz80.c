@@ -10,10 +10,15 @@
 #include <fcntl.h>
 #include "libz80/z80.h"
 #include "z80dis.h"
+#include "profile.h"
 
 static uint8_t ram[65536];
 static Z80Context cpu_z80;
 static unsigned trace;
+static unsigned counting;
+static unsigned profiling;
+static uint64_t tstates;
+static uint64_t instructions;
 
 static uint8_t mem_read(int unused, uint16_t addr)
 {
@@ -70,6 +75,9 @@ static void z80_trace(unsigned unused)
 	static uint32_t lastpc = -1;
 	char buf[256];
 
+	instructions++;
+	if (profiling)
+		profile_step(cpu_z80.M1PC, tstates + cpu_z80.tstates);
 	if (!trace)
 		return;
 	nbytes = 0;
@@ -90,19 +98,40 @@ static void z80_trace(unsigned unused)
 		cpu_z80.R1.wr.IX, cpu_z80.R1.wr.IY, cpu_z80.R1.wr.SP);
 }
 
+/* The batch in progress when we exit has not been added yet */
+static void report(void)
+{
+    unsigned long long total = tstates + cpu_z80.tstates;
+    if (profiling)
+        profile_end(total);
+    if (counting)
+        fprintf(stderr, "cycles %llu instructions %llu\n",
+            total, (unsigned long long)instructions);
+}
 
 int main(int argc, char *argv[])
 {
     int fd;
-    if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+    while (argc > 1 && *argv[1] == '-') {
+        if (strcmp(argv[1], "-d") == 0)
+            trace = 1;
+        else if (strcmp(argv[1], "-c") == 0)
+            counting = 1;
+        else if (strcmp(argv[1], "-p") == 0)
+            profiling = 1;
+        else
+            break;
         argv++;
         argc--;
-        trace = 1;
     }
     if (argc != 3) {
-        fprintf(stderr, "emu85: test map.\n");
+        fprintf(stderr, "emuz80: [-c] [-d] [-p] test map.\n");
         exit(1);
     }
+    if (profiling)
+        profile_init(argv[2], argv[1]);
+    if (counting || profiling)
+        atexit(report);
     fd = open(argv[1], O_RDONLY);
     if (fd == -1) {
         perror(argv[1]);
@@ -122,5 +151,5 @@ int main(int argc, char *argv[])
     cpu_z80.trace = z80_trace;
 
     while(1)
-        Z80ExecuteTStates(&cpu_z80, 1000);
+        tstates += Z80ExecuteTStates(&cpu_z80, 1000);
 }
@@ -12,6 +12,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <arpa/inet.h>
+#include "profile.h"
 
 static uint16_t ram[32768];	/* 32KWord address space */
 static unsigned flag_c;
@@ -26,6 +27,12 @@ static unsigned op_index;
 static unsigned op_indirect;
 static int8_t op_disp;
 static uint16_t ea;
+/* There is no timing model so count memory cycles, which is what most
+   of the time on a real Nova goes on */
+static unsigned long long mem_cycles;
+static unsigned long long instructions;
+static unsigned counting;
+static unsigned profiling;
 
 /*
  *	On a Nova (but not microNova) the addresses 020-037 are special
@@ -34,11 +41,13 @@ static uint16_t ea;
 
 static uint16_t read_mem(uint16_t addr)
 {
+    mem_cycles++;
     return ntohs(ram[addr & 0x7FFF]);
 }
 
 static void write_mem(uint16_t addr, int16_t v)
 {
+    mem_cycles++;
     ram[addr & 0x7FFF] = htons(v);
 }
 
@@ -61,7 +70,7 @@ static uint16_t indirect(uint16_t baddr)
     do {
         /* Autoinc and autodec apply before the indirect read */
         automod(addr);
-        addr = ntohs(ram[addr & 0x7FFF]);
+        addr = read_mem(addr);
         if (n++ == 64) {
             fprintf(stderr, "***indirection loop at %x\n", baddr);
             exit(1);
@@ -453,20 +462,39 @@ void nova_execute_one(unsigned debug)
         oneac_ea();
 }
 
+static void report(void)
+{
+	if (profiling)
+		profile_end(mem_cycles);
+	if (counting)
+		fprintf(stderr, "cycles %llu instructions %llu\n", mem_cycles, instructions);
+}
+
 int main(int argc, char *argv[])
 {
 	int fd;
 	unsigned debug = 0;
 
-	if (argc == 4 && strcmp(argv[1], "-d") == 0) {
+	while (argc > 1 && *argv[1] == '-') {
+		if (strcmp(argv[1], "-d") == 0)
+			debug = 1;
+		else if (strcmp(argv[1], "-c") == 0)
+			counting = 1;
+		else if (strcmp(argv[1], "-p") == 0)
+			profiling = 1;
+		else
+			break;
 		argv++;
 		argc--;
-		debug = 1;
 	}
 	if (argc != 3) {
-		fprintf(stderr, "nova: test map.\n");
+		fprintf(stderr, "nova: [-c] [-d] [-p] test map.\n");
 		exit(1);
 	}
+	if (profiling)
+		profile_init(argv[2], argv[1]);
+	if (counting || profiling)
+		atexit(report);
 	fd = open(argv[1], O_RDONLY);
 	if (fd == -1) {
 		perror(argv[1]);
@@ -481,7 +509,11 @@ int main(int argc, char *argv[])
 
 	reg_pc = 0x0100;
 
-	while (1)
+	while (1) {
+		if (profiling)
+			profile_step(reg_pc, mem_cycles);
 		nova_execute_one(debug);
+		instructions++;
+	}
 	return 0;
 }
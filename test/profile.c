@@ -0,0 +1,253 @@
+/*
+ *	Per symbol cycle profiler for the test emulators
+ *
+ *	The symbols come from the linker map. Each instruction is charged to
+ *	the symbol at or below its address, which gives a flat profile of the
+ *	program including the runtime helpers.
+ *
+ *	We don't decode calls. Arriving at the address of a symbol from code
+ *	belonging to another one counts as a call to it and adds an arc to the
+ *	call graph. That also catches tail jumps into helpers and falling
+ *	through into another entry point, but misses direct recursion.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "profile.h"
+
+#define MAX_SYM		2048
+#define MAX_ARC		8192
+#define ARC_HASH	256
+
+struct psym {
+	char name[32];
+	unsigned addr;
+	unsigned long long cycles;
+	unsigned long long instructions;
+	unsigned long calls;
+};
+
+struct parc {
+	struct parc *next;
+	unsigned from;
+	unsigned to;
+	unsigned long count;
+};
+
+/* Symbol 0 covers anything below the first symbol */
+static struct psym sym[MAX_SYM + 1] = {
+	{ "(unknown)" }
+};
+static unsigned nsym;
+static uint16_t owner[65536];
+
+static struct parc arc[MAX_ARC];
+static struct parc *arc_hash[ARC_HASH];
+static unsigned narc;
+
+static unsigned last;
+static unsigned long long last_cycles;
+static const char *outbase;
+
+/* Compiler internal labels would split up the functions */
+static unsigned wanted(const char *name)
+{
+	if (strncmp(name, "__code_", 7) == 0 || strncmp(name, "__data_", 7) == 0 ||
+	    strncmp(name, "__bss_", 6) == 0 || strncmp(name, "__discard_", 10) == 0)
+		return 0;
+	if (*name == 'L' || *name == 'T')
+		name++;
+	else if (strncmp(name, "Sw", 2) == 0)
+		name += 2;
+	else
+		return 1;
+	return !isdigit((unsigned char)*name);
+}
+
+static int sym_addr_cmp(const void *a, const void *b)
+{
+	const struct psym *x = a;
+	const struct psym *y = b;
+	return x->addr - y->addr;
+}
+
+/* Maps are either "addr type name", "addr name" or "name addr type" */
+static void load_map(const char *path)
+{
+	FILE *fp = fopen(path, "r");
+	char buf[128];
+	char a[32], b[32], c[32];
+	char *name, *end;
+	unsigned long addr;
+	unsigned i, n;
+
+	if (fp == NULL) {
+		perror(path);
+		exit(1);
+	}
+	while (fgets(buf, sizeof(buf), fp) && nsym < MAX_SYM) {
+		n = sscanf(buf, "%31s %31s %31s", a, b, c);
+		if (n < 2)
+			continue;
+		addr = strtoul(a, &end, 16);
+		if (*end == 0)
+			name = n == 3 ? c : b;
+		else {
+			addr = strtoul(b, &end, 16);
+			if (*end)
+				continue;
+			name = a;
+		}
+		if (addr > 0xFFFF || !wanted(name))
+			continue;
+		nsym++;
+		strcpy(sym[nsym].name, name);
+		sym[nsym].addr = addr;
+	}
+	fclose(fp);
+
+	qsort(sym + 1, nsym, sizeof(struct psym), sym_addr_cmp);
+	n = 0;
+	for (i = 0; i < 65536; i++) {
+		while (n < nsym && sym[n + 1].addr <= i)
+			n++;
+		owner[i] = n;
+	}
+}
+
+void profile_init(const char *map, const char *base)
+{
+	load_map(map);
+	outbase = base;
+}
+
+static void add_arc(unsigned from, unsigned to)
+{
+	unsigned h = (from * 31 + to) % ARC_HASH;
+	struct parc *a = arc_hash[h];
+
+	while (a) {
+		if (a->from == from && a->to == to) {
+			a->count++;
+			return;
+		}
+		a = a->next;
+	}
+	if (narc == MAX_ARC)
+		return;
+	a = arc + narc++;
+	a->from = from;
+	a->to = to;
+	a->count = 1;
+	a->next = arc_hash[h];
+	arc_hash[h] = a;
+}
+
+void profile_step(uint16_t pc, unsigned long long cycles)
+{
+	unsigned s = owner[pc];
+
+	/* The previous instruction is done so we now know what it cost */
+	sym[last].cycles += cycles - last_cycles;
+	last_cycles = cycles;
+
+	if (s != last && pc == sym[s].addr) {
+		sym[s].calls++;
+		add_arc(last, s);
+	}
+	sym[s].instructions++;
+	last = s;
+}
+
+static int sym_cycle_cmp(const void *a, const void *b)
+{
+	const struct psym *x = *(const struct psym **)a;
+	const struct psym *y = *(const struct psym **)b;
+	if (x->cycles != y->cycles)
+		return x->cycles < y->cycles ? 1 : -1;
+	return strcmp(x->name, y->name);
+}
+
+static int arc_cmp(const void *a, const void *b)
+{
+	const struct parc *x = a;
+	const struct parc *y = b;
+	if (x->from != y->from)
+		return strcmp(sym[x->from].name, sym[y->from].name);
+	if (x->count != y->count)
+		return x->count < y->count ? 1 : -1;
+	return strcmp(sym[x->to].name, sym[y->to].name);
+}
+
+static FILE *open_out(const char *ext)
+{
+	char path[512];
+	FILE *fp;
+
+	snprintf(path, sizeof(path), "%s.%s", outbase, ext);
+	fp = fopen(path, "w");
+	if (fp == NULL)
+		perror(path);
+	return fp;
+}
+
+void profile_end(unsigned long long cycles)
+{
+	struct psym **order;
+	struct psym *s;
+	unsigned long long total;
+	unsigned i, n;
+	FILE *fp;
+
+	/* Charge the instruction we exited in */
+	sym[last].cycles += cycles - last_cycles;
+	last_cycles = cycles;
+
+	fp = open_out("prof");
+	if (fp) {
+		order = malloc((nsym + 1) * sizeof(struct psym *));
+		if (order == NULL) {
+			fprintf(stderr, "profile: out of memory.\n");
+			exit(1);
+		}
+		n = 0;
+		total = 0;
+		for (i = 0; i <= nsym; i++) {
+			if (sym[i].instructions) {
+				order[n++] = sym + i;
+				total += sym[i].cycles;
+			}
+		}
+		qsort(order, n, sizeof(struct psym *), sym_cycle_cmp);
+		fprintf(fp, "%6s %12s %12s %10s %10s  %s\n",
+			"%", "cycles", "instructions", "calls", "cyc/call", "name");
+		for (i = 0; i < n; i++) {
+			s = order[i];
+			fprintf(fp, "%6.2f %12llu %12llu %10lu %10llu  %s\n",
+				total ? 100.0 * s->cycles / total : 0.0,
+				s->cycles, s->instructions, s->calls,
+				s->calls ? s->cycles / s->calls : 0ULL, s->name);
+		}
+		fprintf(fp, "%6s %12llu\n", "total", total);
+		free(order);
+		fclose(fp);
+	}
+
+	/* The call graph is callers in name order, busiest arcs first */
+	fp = open_out("graph");
+	if (fp) {
+		qsort(arc, narc, sizeof(struct parc), arc_cmp);
+		for (i = 0; i < narc; i++) {
+			if (i == 0 || arc[i].from != arc[i - 1].from)
+				fprintf(fp, "%s\n", sym[arc[i].from].name);
+			fprintf(fp, "\t%10lu  %s\n", arc[i].count, sym[arc[i].to].name);
+		}
+		if (narc == MAX_ARC)
+			fprintf(fp, "(arc table full)\n");
+		fclose(fp);
+	}
+}
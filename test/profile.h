@@ -0,0 +1,10 @@
+/*
+ *	Per symbol cycle profiler shared by the test emulators
+ */
+
+/* Set up from the linker map, output goes to base.prof and base.graph */
+extern void profile_init(const char *map, const char *base);
+/* Called before each instruction with the running cycle count */
+extern void profile_step(uint16_t pc, unsigned long long cycles);
+/* Called at exit with the final cycle count */
+extern void profile_end(unsigned long long cycles);
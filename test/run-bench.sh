@@ -0,0 +1,100 @@
+#!/bin/sh
+#
+#	Build and run the benchmarks in bench/ for each CPU with an emulator
+#	at each optimisation level and record cycles and code size
+#
+#	run-bench.sh [-o results.csv] [-O "levels"] [cpu...]
+#
+#	The CSV has one line per run: cpu,opt,bench,status,cycles,instructions,text
+#	where text is the __code_size from the link map. Compare two runs
+#	with bench-compare.sh.
+#
+OUT=bench.csv
+LEVELS="-O0 -O2 -Os"
+CPUS="8080 8085 z80 6502 6800 6803 6303 hc11 6809 z8 nova nova3"
+LIB=/opt/fcc/lib
+
+while [ $# -gt 0 ]
+do
+	case $1 in
+	-o)	OUT=$2; shift 2;;
+	-O)	LEVELS=$2; shift 2;;
+	*)	break;;
+	esac
+done
+[ $# -gt 0 ] && CPUS="$*"
+
+# Set the fcc flag, start up, linker and emulator for a cpu. These follow
+# the run-test*.sh scripts. EMUARG goes after the emulator options
+target() {
+	MCPU=-m$1
+	EMUARG=
+	case $1 in
+	8080)	CRT=testcrt0.o; LD="ld8080 -b -C0"; LIBS=$LIB/8080/lib8080.a
+		EMU=./emu85;;
+	8085)	CRT=testcrt0.o; LD="ld8080 -b -C0"; LIBS=$LIB/8085/lib8085.a
+		EMU=./emu85;;
+	z80)	CRT=testcrtz80.o; LD="ldz80 -b -C0"; LIBS=$LIB/z80/libz80.a
+		EMU=./emuz80;;
+	6502)	CRT=testcrt0_6502.o; LD="ld6502 -b -C512"
+		LIBS=$LIB/6502/lib6502.a; EMU=./emu6502;;
+	6800)	CRT=testcrt0_6800.o; LD="ld6800 -b -C256 -Z0"
+		LIBS="$LIB/6800/lib6800.a $LIB/6800/libc.a"; EMU=./emu6800; EMUARG=6800;;
+	6803)	CRT=testcrt0_6803.o; LD="ld6800 -b -C256 -Z64"
+		LIBS=$LIB/6803/lib6803.a; EMU=./emu6800; EMUARG=6803;;
+	6303)	CRT=testcrt0_6303.o; LD="ld6800 -b -C256 -Z64"
+		LIBS=$LIB/6303/lib6303.a; EMU=./emu6800; EMUARG=6303;;
+	hc11)	MCPU=-m68hc11; CRT=testcrt0_6803.o; LD="ld6800 -b -C32768"
+		LIBS=$LIB/hc11/libhc11.a; EMU=./emu6800; EMUARG=6811;;
+	6809)	CRT=testcrt0_6809.o; LD="ld6809 -b -C512"
+		LIBS=$LIB/6809/lib6809.a; EMU=./emu6809;;
+	z8)	CRT=testcrt0_z8.o; LD="ldz8 -b -C0 -Z48"; LIBS=$LIB/z8/libz8.a
+		EMU=./emuz8;;
+	nova)	CRT=testcrt0_nova.o; LD="ldnova -b -C512 -Z80"
+		LIBS=$LIB/nova/libnova.a; EMU=./nova;;
+	nova3)	CRT=testcrt0_nova3.o; LD="ldnova -b -C512 -Z80"
+		LIBS=$LIB/nova/libnova3.a; EMU=./nova;;
+	*)	return 1;;
+	esac
+	return 0
+}
+
+echo "cpu,opt,bench,status,cycles,instructions,text" >$OUT
+
+for cpu in $CPUS
+do
+	if ! target $cpu; then
+		echo "$cpu: no emulator" >&2
+		continue
+	fi
+	for opt in $LEVELS
+	do
+		for i in bench/*.c
+		do
+			b=bench/$(basename $i .c)
+			cycles=
+			instr=
+			text=
+			if ! fcc $opt $MCPU -c $i; then
+				status=compile
+			elif ! $LD $CRT $b.o -o $b $LIBS -m $b.map; then
+				status=link
+			else
+				text=$(awk '$NF == "__code_size" { print $1 }' $b.map)
+				[ -n "$text" ] && text=$(printf "%d" 0x$text)
+				timeout 120 $EMU -c $EMUARG $b $b.map >/dev/null 2>$b.err
+				case $? in
+				0)	status=ok;;
+				124)	status=timeout;;
+				*)	status=fail;;
+				esac
+				set -- $(grep '^cycles ' $b.err)
+				cycles=$2
+				instr=$4
+			fi
+			echo "$cpu $opt $(basename $b): $status $cycles"
+			echo "$cpu,$opt,$(basename $b),$status,$cycles,$instr,$text" >>$OUT
+			rm -f $b $b.o $b.map $b.err
+		done
+	done
+done
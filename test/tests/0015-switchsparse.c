@@ -0,0 +1,123 @@
+
+/* Sparse switches big enough to be searched and small ones done in line */
+
+static unsigned sparse(int i)
+{
+    switch(i) {
+    case -32768:
+        return 1;
+    case -1000:
+        return 2;
+    case -1:
+        return 3;
+    case 0:
+        return 4;
+    case 7:
+        return 5;
+    case 300:
+        return 6;
+    case 1000:
+        return 7;
+    case 4097:
+        return 8;
+    case 20000:
+        return 9;
+    case 32767:
+        return 10;
+    }
+    return 0;
+}
+
+static unsigned usparse(unsigned i)
+{
+    switch(i) {
+    case 0:
+        return 1;
+    case 3:
+        return 2;
+    case 255:
+        return 3;
+    case 256:
+        return 4;
+    case 0x7FFF:
+        return 5;
+    case 0x8000:
+        return 6;
+    case 0xC000:
+        return 7;
+    case 0xFFFE:
+        return 8;
+    case 0xFFFF:
+        return 9;
+    }
+    return 0;
+}
+
+static unsigned small(int i)
+{
+    switch(i) {
+    case -5:
+        return 1;
+    case 12:
+        return 2;
+    case 900:
+        return 3;
+    }
+    return 0;
+}
+
+static unsigned csparse(signed char c)
+{
+    switch(c) {
+    case -128:
+        return 1;
+    case -50:
+        return 2;
+    case -1:
+        return 3;
+    case 0:
+        return 4;
+    case 9:
+        return 5;
+    case 33:
+        return 6;
+    case 100:
+        return 7;
+    case 127:
+        return 8;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (sparse(-32768) != 1 || sparse(-1000) != 2 || sparse(-1) != 3)
+        return 1;
+    if (sparse(0) != 4 || sparse(7) != 5 || sparse(300) != 6)
+        return 2;
+    if (sparse(1000) != 7 || sparse(4097) != 8 || sparse(20000) != 9)
+        return 3;
+    if (sparse(32767) != 10)
+        return 4;
+    if (sparse(-32767) || sparse(-999) || sparse(1) || sparse(8) || sparse(4096) || sparse(32766))
+        return 5;
+    if (usparse(0) != 1 || usparse(3) != 2 || usparse(255) != 3 || usparse(256) != 4)
+        return 6;
+    if (usparse(0x7FFF) != 5 || usparse(0x8000) != 6 || usparse(0xC000) != 7)
+        return 7;
+    if (usparse(0xFFFE) != 8 || usparse(0xFFFF) != 9)
+        return 8;
+    if (usparse(1) || usparse(254) || usparse(0x8001) || usparse(0xFFFD))
+        return 9;
+    if (small(-5) != 1 || small(12) != 2 || small(900) != 3)
+        return 10;
+    if (small(-4) || small(0) || small(13) || small(-900))
+        return 11;
+    if (csparse(-128) != 1 || csparse(-50) != 2 || csparse(-1) != 3 || csparse(0) != 4)
+        return 12;
+    if (csparse(9) != 5 || csparse(33) != 6 || csparse(100) != 7 || csparse(127) != 8)
+        return 13;
+    if (csparse(-127) || csparse(1) || csparse(126) || csparse(-2))
+        return 14;
+    return 0;
+}
@@ -0,0 +1,108 @@
+
+/* Dense switches with holes, indexed directly */
+
+static unsigned dense(int i)
+{
+    switch(i) {
+    case -3:
+        return 1;
+    case -2:
+        return 2;
+    case 0:
+        return 3;
+    case 1:
+        return 4;
+    case 2:
+        return 5;
+    case 3:
+        return 6;
+    case 5:
+        return 7;
+    case 6:
+        return 8;
+    case 7:
+        return 9;
+    }
+    return 0;
+}
+
+static unsigned udense(unsigned i)
+{
+    switch(i) {
+    case 0xFFF0:
+        return 1;
+    case 0xFFF1:
+        return 2;
+    case 0xFFF2:
+        return 3;
+    case 0xFFF4:
+        return 4;
+    case 0xFFF5:
+        return 5;
+    }
+    return 0;
+}
+
+static unsigned cdense(signed char c)
+{
+    switch(c) {
+    case -2:
+        return 1;
+    case -1:
+        return 2;
+    case 0:
+        return 3;
+    case 1:
+        return 4;
+    case 3:
+        return 5;
+    }
+    return 0;
+}
+
+static unsigned ucdense(unsigned char c)
+{
+    switch(c) {
+    case 250:
+        return 1;
+    case 251:
+        return 2;
+    case 252:
+        return 3;
+    case 253:
+        return 4;
+    case 254:
+        return 5;
+    case 255:
+        return 6;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int i;
+    unsigned r;
+
+    if (dense(-3) != 1 || dense(-2) != 2 || dense(0) != 3 || dense(3) != 6 || dense(7) != 9)
+        return 1;
+    if (dense(-4) || dense(-1) || dense(4) || dense(8) || dense(-32768) || dense(32767))
+        return 2;
+    if (udense(0xFFF0) != 1 || udense(0xFFF2) != 3 || udense(0xFFF5) != 5)
+        return 3;
+    if (udense(0xFFEF) || udense(0xFFF3) || udense(0xFFF6) || udense(0) || udense(0xFFFF))
+        return 4;
+    if (cdense(-2) != 1 || cdense(-1) != 2 || cdense(0) != 3 || cdense(1) != 4 || cdense(3) != 5)
+        return 5;
+    if (cdense(-3) || cdense(2) || cdense(4) || cdense(-128) || cdense(127))
+        return 6;
+    for (i = 0; i < 256; i++) {
+        r = ucdense(i);
+        if (i >= 250) {
+            if (r != i - 249)
+                return 7;
+        } else if (r)
+            return 8;
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+
+/* Repeated subexpressions within a statement */
+
+struct n {
+    struct n *next;
+    int a;
+    int b;
+    unsigned char c;
+};
+
+struct n x, y, z;
+int arr[10];
+
+static int sub(int p, int q)
+{
+    return p - q;
+}
+
+static int val(struct n *p)
+{
+    return p->next->a * 2 + p->next->b;
+}
+
+int main(int argc, char *argv[])
+{
+    struct n *p = &x;
+    int i = 3;
+
+    x.next = &y;
+    y.next = &z;
+    y.a = 5;
+    y.b = 7;
+    p->next->a = p->next->b + p->next->a;
+    if (y.a != 12)
+        return 1;
+    p->next->next->c = p->next->next->c + p->next->b;
+    if (z.c != 7)
+        return 2;
+    arr[i * 2 + 1] = arr[i * 2 + 1] + arr[i * 2 + 1] + 4;
+    if (arr[7] != 4)
+        return 3;
+    i = sub(p->next->a, p->next->b);
+    if (i != 5)
+        return 4;
+    /* Side effects must stop us */
+    p->next->a = p->next->b++ + p->next->a;
+    if (y.a != 19 || y.b != 8)
+        return 5;
+    p->next->b = sub(p->next->a, 4) + p->next->b;
+    if (y.b != 23)
+        return 6;
+    /* and the right of && must not be pulled forward */
+    p = 0;
+    i = p && p->next->a == p->next->b;
+    if (i)
+        return 7;
+    p = &x;
+    i = p->next->a > 10 ? p->next->a - p->next->b : p->next->b;
+    if (i != -4)
+        return 8;
+    return val(p) - 61;
+}
@@ -0,0 +1,115 @@
+/* Stores to locals that are never used */
+
+int calls;
+int g;
+
+static int count(int v)
+{
+    calls++;
+    return v;
+}
+
+static void set(int *p, int v)
+{
+    *p = v;
+}
+
+/* Stored again before use, and stored and never read */
+static int over(int y)
+{
+    int x;
+    int unused;
+    x = 0;
+    unused = y * 3;
+    x = y;
+    unused = x + 1;
+    return x;
+}
+
+/* The call must still happen even if the value is not wanted */
+static int effect(int y)
+{
+    int x;
+    x = count(y);
+    x = y + 1;
+    return x;
+}
+
+/* Arguments are locals too, and the store before return is not used */
+static int arg(int a, int b)
+{
+    a = b;
+    b = a + 1;
+    return a;
+}
+
+static int loop(int n)
+{
+    int i;
+    int t = 0;
+    int last = -1;
+    for (i = 0; i < n; i = i + 1) {
+        last = t;
+        t = i * 2;
+    }
+    return t + last;
+}
+
+/* Only some paths store it again */
+static int branch(int c)
+{
+    int x = 5;
+    if (c)
+        x = 7;
+    return x;
+}
+
+static int jump(int c)
+{
+    int x = 1;
+    if (c)
+        goto out;
+    x = 2;
+out:
+    return x;
+}
+
+/* The address is taken so the stores must all stay */
+static int addr(void)
+{
+    int x;
+    x = 3;
+    set(&x, x + 1);
+    return x;
+}
+
+static int byte(int v)
+{
+    unsigned char c;
+    int x;
+    x = v;
+    c = x;
+    x = 0;
+    return c + x;
+}
+
+int main(int argc, char *argv[])
+{
+    if (over(4) != 4)
+        return 1;
+    if (effect(4) != 5 || calls != 1)
+        return 2;
+    if (arg(1, 2) != 2)
+        return 3;
+    if (loop(4) != 10)
+        return 4;
+    if (branch(0) != 5 || branch(1) != 7)
+        return 5;
+    if (jump(0) != 2 || jump(1) != 1)
+        return 6;
+    if (addr() != 4)
+        return 7;
+    if (byte(0x1234) != 0x34)
+        return 8;
+    return 0;
+}
@@ -0,0 +1,154 @@
+/* Array indexing in loops turned into pointer steps */
+
+struct rec {
+    int key;
+    int val;
+    char flag;
+};
+
+struct rec r[10];
+int a[20];
+int b[20];
+
+static void set(int *p)
+{
+    *p = 7;
+}
+
+static int sum(int *p, int n)
+{
+    int i;
+    int t = 0;
+    for (i = 0; i < n; i++)
+        t += p[i] + p[i];
+    return t;
+}
+
+static void copy(int *d, int *s, int n)
+{
+    int i;
+    for (i = n - 1; i >= 0; i--)
+        d[i] = s[i];
+}
+
+/* Every third one, skipping some with continue */
+static int third(void)
+{
+    int i;
+    int t = 0;
+    for (i = 0; i < 20; i += 3) {
+        if (a[i] == 6)
+            continue;
+        t += a[i] + b[i];
+    }
+    return t;
+}
+
+static int recs(void)
+{
+    int i, j;
+    int t = 0;
+    for (j = 0; j < 3; j++)
+        for (i = 0; i < 10; i++) {
+            r[i].key = i;
+            r[i].val = r[i].key + j;
+            r[i].flag = 1;
+        }
+    for (i = 0; i < 10; i++)
+        t += r[i].val * r[i].flag;
+    return t;
+}
+
+/* The base changes so this has to be left alone */
+static int moved(int *p)
+{
+    int i;
+    int t = 0;
+    for (i = 0; i < 4; i++) {
+        t += p[i] + p[i];
+        p++;
+    }
+    return t;
+}
+
+/* As does a counter changed in the loop */
+static int skip(void)
+{
+    int i;
+    int t = 0;
+    for (i = 0; i < 10; i++) {
+        t += a[i] * a[i];
+        i++;
+    }
+    return t;
+}
+
+/* Or one whose address is taken */
+static int addr(void)
+{
+    int i;
+    int t = 0;
+    for (i = 0; i < 10; i++) {
+        t += b[i] + b[i];
+        if (i == 2)
+            set(&i);
+    }
+    return t;
+}
+
+static int local(void)
+{
+    int i;
+    int t = 0;
+    int x[8];
+    for (i = 0; i < 8; i++)
+        x[i] = i * 3;
+    for (i = 0; i < 8; i++)
+        t += x[i] + x[i];
+    return t;
+}
+
+static int sw(int c)
+{
+    int i;
+    int t = 0;
+    for (i = 0; i < 5; i++) {
+        switch (c) {
+        case 1:
+            t += a[i] + a[i];
+            break;
+        default:
+            t += b[i] + b[i];
+        }
+    }
+    return t;
+}
+
+int main(int argc, char *argv[])
+{
+    int i;
+
+    for (i = 0; i < 20; i++)
+        a[i] = i;
+    if (sum(a, 10) != 90)
+        return 1;
+    copy(b, a, 20);
+    if (b[0] != 0 || b[19] != 19)
+        return 2;
+    /* 0 3 9 12 15 18 doubled */
+    if (third() != 114)
+        return 3;
+    if (recs() != 65)
+        return 4;
+    if (moved(a) != 24)
+        return 5;
+    if (skip() != 120)
+        return 6;
+    if (addr() != 40)
+        return 7;
+    if (local() != 168)
+        return 8;
+    if (sw(1) != 20 || sw(0) != 20)
+        return 9;
+    return 0;
+}
@@ -0,0 +1,33 @@
+
+/* More names and array types than the old 1024 entry tables held */
+
+#define D10(m, a, b)	m(a, b, 0) m(a, b, 1) m(a, b, 2) m(a, b, 3) m(a, b, 4) \
+			m(a, b, 5) m(a, b, 6) m(a, b, 7) m(a, b, 8) m(a, b, 9)
+#define D100(m, a)	D10(m, a, 0) D10(m, a, 1) D10(m, a, 2) D10(m, a, 3) \
+			D10(m, a, 4) D10(m, a, 5) D10(m, a, 6) D10(m, a, 7) \
+			D10(m, a, 8) D10(m, a, 9)
+#define D1000(m)	D100(m, 0) D100(m, 1) D100(m, 2) D100(m, 3) D100(m, 4) \
+			D100(m, 5) D100(m, 6) D100(m, 7) D100(m, 8) D100(m, 9)
+
+/* 3000 names */
+#define NAMES(a, b, c)	extern int x##a##b##c, y##a##b##c, z##a##b##c;
+D1000(NAMES)
+
+/* 800 array types, each its own symbol slot */
+#define ARRAYS(a, b, c)	extern char t##a##b##c[1##a##b##c];
+D100(ARRAYS, 0) D100(ARRAYS, 1) D100(ARRAYS, 2) D100(ARRAYS, 3)
+D100(ARRAYS, 4) D100(ARRAYS, 5) D100(ARRAYS, 6) D100(ARRAYS, 7)
+
+int z999 = 3;
+char t799[1799];
+
+int main(int argc, char *argv[])
+{
+    if (z999 != 3)
+        return 1;
+    if (sizeof(t799) != 1799)
+        return 2;
+    if (sizeof(t123) != 1123)
+        return 3;
+    return 0;
+}
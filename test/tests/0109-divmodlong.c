@@ -4,6 +4,11 @@ long mul(long a, long b)
     return a * b;
 }
 
+unsigned long mulu(unsigned long a, unsigned long b)
+{
+    return a * b;
+}
+
 unsigned long divu(unsigned long a, unsigned long b)
 {
     return a / b;
@@ -32,6 +37,9 @@ int main(int argc, char *argv[])
         return 1;
     if (mul(0xFF,0) != 0)
         return 2;
+    /* Carry out of the low half with an odd upper half */
+    if (mulu(0x31DFF4F5UL, 1103515245UL) != 0x237BF251UL)
+        return 20;
     if (divu(200, 10) != 20)
         return 3;
     if (divu(10, 10) != 1)
@@ -0,0 +1,117 @@
+
+/* Long switches, sparse, signed and unsigned */
+
+static unsigned lsparse(long l)
+{
+    switch(l) {
+    case -2147483647L - 1:
+        return 1;
+    case -70000L:
+        return 2;
+    case -1L:
+        return 3;
+    case 0L:
+        return 4;
+    case 5L:
+        return 5;
+    case 65535L:
+        return 6;
+    case 65536L:
+        return 7;
+    case 1000000L:
+        return 8;
+    case 2147483647L:
+        return 9;
+    }
+    return 0;
+}
+
+static unsigned ulsparse(unsigned long l)
+{
+    switch(l) {
+    case 0UL:
+        return 1;
+    case 0xFFFFUL:
+        return 2;
+    case 0x10000UL:
+        return 3;
+    case 0x7FFFFFFFUL:
+        return 4;
+    case 0x80000000UL:
+        return 5;
+    case 0xFFFFFFFFUL:
+        return 6;
+    }
+    return 0;
+}
+
+static unsigned lsmall(long l)
+{
+    switch(l) {
+    case -3L:
+        return 1;
+    case 0x12345678L:
+        return 2;
+    }
+    return 0;
+}
+
+/* Cases spanning the whole range must not be taken for a dense table */
+static unsigned ulspan(unsigned long l)
+{
+    switch(l) {
+    case 0UL:
+        return 1;
+    case 1UL:
+        return 2;
+    case 2UL:
+        return 3;
+    case 0xFFFFFFFFUL:
+        return 4;
+    }
+    return 0;
+}
+
+static unsigned lspan(long l)
+{
+    switch(l) {
+    case -2147483647L - 1:
+        return 1;
+    case 0L:
+        return 2;
+    case 1L:
+        return 3;
+    case 2147483647L:
+        return 4;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (lsparse(-2147483647L - 1) != 1 || lsparse(-70000L) != 2 || lsparse(-1L) != 3)
+        return 1;
+    if (lsparse(0L) != 4 || lsparse(5L) != 5 || lsparse(65535L) != 6)
+        return 2;
+    if (lsparse(65536L) != 7 || lsparse(1000000L) != 8 || lsparse(2147483647L) != 9)
+        return 3;
+    if (lsparse(-2147483647L) || lsparse(-69999L) || lsparse(1L) || lsparse(65537L) || lsparse(-65536L))
+        return 4;
+    if (ulsparse(0UL) != 1 || ulsparse(0xFFFFUL) != 2 || ulsparse(0x10000UL) != 3)
+        return 5;
+    if (ulsparse(0x7FFFFFFFUL) != 4 || ulsparse(0x80000000UL) != 5 || ulsparse(0xFFFFFFFFUL) != 6)
+        return 6;
+    if (ulsparse(1UL) || ulsparse(0x1FFFFUL) || ulsparse(0x80000001UL) || ulsparse(0xFFFFFFFEUL))
+        return 7;
+    if (lsmall(-3L) != 1 || lsmall(0x12345678L) != 2 || lsmall(3L) || lsmall(0x5678L))
+        return 8;
+    if (ulspan(0UL) != 1 || ulspan(1UL) != 2 || ulspan(2UL) != 3 || ulspan(0xFFFFFFFFUL) != 4)
+        return 9;
+    if (ulspan(3UL) || ulspan(0xFFFFFFFEUL))
+        return 10;
+    if (lspan(-2147483647L - 1) != 1 || lspan(0L) != 2 || lspan(1L) != 3 || lspan(2147483647L) != 4)
+        return 11;
+    if (lspan(-1L) || lspan(2L) || lspan(2147483646L))
+        return 12;
+    return 0;
+}
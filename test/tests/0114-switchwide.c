@@ -0,0 +1,301 @@
+/* Switches with enough cases to use the binary search helpers on every
+   target, in each type */
+
+static unsigned wide(int i)
+{
+    switch(i) {
+    case -32768:
+        return 1;
+    case -20000:
+        return 2;
+    case -1000:
+        return 3;
+    case -300:
+        return 4;
+    case -17:
+        return 5;
+    case -1:
+        return 6;
+    case 0:
+        return 7;
+    case 1:
+        return 8;
+    case 7:
+        return 9;
+    case 64:
+        return 10;
+    case 300:
+        return 11;
+    case 1000:
+        return 12;
+    case 4097:
+        return 13;
+    case 9999:
+        return 14;
+    case 20000:
+        return 15;
+    case 32767:
+        return 16;
+    }
+    return 0;
+}
+
+static unsigned uwide(unsigned i)
+{
+    switch(i) {
+    case 0:
+        return 1;
+    case 1:
+        return 2;
+    case 3:
+        return 3;
+    case 100:
+        return 4;
+    case 255:
+        return 5;
+    case 256:
+        return 6;
+    case 1000:
+        return 7;
+    case 16384:
+        return 8;
+    case 32767:
+        return 9;
+    case 32768:
+        return 10;
+    case 32769:
+        return 11;
+    case 40960:
+        return 12;
+    case 49152:
+        return 13;
+    case 61440:
+        return 14;
+    case 65534:
+        return 15;
+    case 65535:
+        return 16;
+    }
+    return 0;
+}
+
+static unsigned cwide(signed char c)
+{
+    switch(c) {
+    case -128:
+        return 1;
+    case -100:
+        return 2;
+    case -64:
+        return 3;
+    case -50:
+        return 4;
+    case -20:
+        return 5;
+    case -3:
+        return 6;
+    case -1:
+        return 7;
+    case 0:
+        return 8;
+    case 1:
+        return 9;
+    case 2:
+        return 10;
+    case 9:
+        return 11;
+    case 33:
+        return 12;
+    case 64:
+        return 13;
+    case 100:
+        return 14;
+    case 126:
+        return 15;
+    case 127:
+        return 16;
+    }
+    return 0;
+}
+
+static unsigned ucwide(unsigned char c)
+{
+    switch(c) {
+    case 0:
+        return 1;
+    case 1:
+        return 2;
+    case 2:
+        return 3;
+    case 5:
+        return 4;
+    case 16:
+        return 5;
+    case 64:
+        return 6;
+    case 100:
+        return 7;
+    case 127:
+        return 8;
+    case 128:
+        return 9;
+    case 129:
+        return 10;
+    case 160:
+        return 11;
+    case 200:
+        return 12;
+    case 250:
+        return 13;
+    case 253:
+        return 14;
+    case 254:
+        return 15;
+    case 255:
+        return 16;
+    }
+    return 0;
+}
+
+static unsigned lwide(long l)
+{
+    switch(l) {
+    case -2147483647L - 1:
+        return 1;
+    case -1000000L:
+        return 2;
+    case -70000L:
+        return 3;
+    case -65536L:
+        return 4;
+    case -32768L:
+        return 5;
+    case -1L:
+        return 6;
+    case 0L:
+        return 7;
+    case 1L:
+        return 8;
+    case 5L:
+        return 9;
+    case 32768L:
+        return 10;
+    case 65535L:
+        return 11;
+    case 65536L:
+        return 12;
+    case 70000L:
+        return 13;
+    case 1000000L:
+        return 14;
+    case 0x40000000L:
+        return 15;
+    case 2147483647L:
+        return 16;
+    }
+    return 0;
+}
+
+static unsigned ulwide(unsigned long l)
+{
+    switch(l) {
+    case 0UL:
+        return 1;
+    case 1UL:
+        return 2;
+    case 0xFFUL:
+        return 3;
+    case 0xFFFFUL:
+        return 4;
+    case 0x10000UL:
+        return 5;
+    case 0x10001UL:
+        return 6;
+    case 0x123456UL:
+        return 7;
+    case 0x1000000UL:
+        return 8;
+    case 0x7FFFFFFEUL:
+        return 9;
+    case 0x7FFFFFFFUL:
+        return 10;
+    case 0x80000000UL:
+        return 11;
+    case 0x80000001UL:
+        return 12;
+    case 0xC0000000UL:
+        return 13;
+    case 0xF0000000UL:
+        return 14;
+    case 0xFFFFFFFEUL:
+        return 15;
+    case 0xFFFFFFFFUL:
+        return 16;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (wide(-32768) != 1 || wide(-20000) != 2 || wide(-1000) != 3 || wide(-300) != 4)
+        return 1;
+    if (wide(-17) != 5 || wide(-1) != 6 || wide(0) != 7 || wide(1) != 8)
+        return 2;
+    if (wide(7) != 9 || wide(64) != 10 || wide(300) != 11 || wide(1000) != 12)
+        return 3;
+    if (wide(4097) != 13 || wide(9999) != 14 || wide(20000) != 15 || wide(32767) != 16)
+        return 4;
+    if (wide(-32767) || wide(-2) || wide(2) || wide(8) || wide(4096) || wide(32766))
+        return 5;
+    if (uwide(0) != 1 || uwide(1) != 2 || uwide(3) != 3 || uwide(100) != 4)
+        return 6;
+    if (uwide(255) != 5 || uwide(256) != 6 || uwide(1000) != 7 || uwide(16384) != 8)
+        return 7;
+    if (uwide(32767) != 9 || uwide(32768) != 10 || uwide(32769) != 11 || uwide(40960) != 12)
+        return 8;
+    if (uwide(49152) != 13 || uwide(61440) != 14 || uwide(65534) != 15 || uwide(65535) != 16)
+        return 9;
+    if (uwide(2) || uwide(254) || uwide(32766) || uwide(32770) || uwide(65533))
+        return 10;
+    if (cwide(-128) != 1 || cwide(-100) != 2 || cwide(-64) != 3 || cwide(-50) != 4)
+        return 11;
+    if (cwide(-20) != 5 || cwide(-3) != 6 || cwide(-1) != 7 || cwide(0) != 8)
+        return 12;
+    if (cwide(1) != 9 || cwide(2) != 10 || cwide(9) != 11 || cwide(33) != 12)
+        return 13;
+    if (cwide(64) != 13 || cwide(100) != 14 || cwide(126) != 15 || cwide(127) != 16)
+        return 14;
+    if (cwide(-127) || cwide(-2) || cwide(3) || cwide(99) || cwide(125))
+        return 15;
+    if (ucwide(0) != 1 || ucwide(1) != 2 || ucwide(2) != 3 || ucwide(5) != 4)
+        return 16;
+    if (ucwide(16) != 5 || ucwide(64) != 6 || ucwide(100) != 7 || ucwide(127) != 8)
+        return 17;
+    if (ucwide(128) != 9 || ucwide(129) != 10 || ucwide(160) != 11 || ucwide(200) != 12)
+        return 18;
+    if (ucwide(250) != 13 || ucwide(253) != 14 || ucwide(254) != 15 || ucwide(255) != 16)
+        return 19;
+    if (ucwide(3) || ucwide(126) || ucwide(130) || ucwide(252))
+        return 20;
+    if (lwide(-2147483647L - 1) != 1 || lwide(-1000000L) != 2 || lwide(-70000L) != 3 || lwide(-65536L) != 4)
+        return 21;
+    if (lwide(-32768L) != 5 || lwide(-1L) != 6 || lwide(0L) != 7 || lwide(1L) != 8)
+        return 22;
+    if (lwide(5L) != 9 || lwide(32768L) != 10 || lwide(65535L) != 11 || lwide(65536L) != 12)
+        return 23;
+    if (lwide(70000L) != 13 || lwide(1000000L) != 14 || lwide(0x40000000L) != 15 || lwide(2147483647L) != 16)
+        return 24;
+    if (lwide(-2147483647L) || lwide(-65535L) || lwide(2L) || lwide(65537L) || lwide(2147483646L))
+        return 25;
+    if (ulwide(0UL) != 1 || ulwide(1UL) != 2 || ulwide(0xFFUL) != 3 || ulwide(0xFFFFUL) != 4)
+        return 26;
+    if (ulwide(0x10000UL) != 5 || ulwide(0x10001UL) != 6 || ulwide(0x123456UL) != 7 || ulwide(0x1000000UL) != 8)
+        return 27;
+    if (ulwide(0x7FFFFFFEUL) != 9 || ulwide(0x7FFFFFFFUL) != 10 || ulwide(0x80000000UL) != 11 || ulwide(0x80000001UL) != 12)
+        return 28;
+    if (ulwide(0xC0000000UL) != 13 || ulwide(0xF0000000UL) != 14 || ulwide(0xFFFFFFFEUL) != 15 || ulwide(0xFFFFFFFFUL) != 16)
+        return 29;
+    if (ulwide(2UL) || ulwide(0x10002UL) || ulwide(0x80000002UL) || ulwide(0xFFFFFFFDUL))
+        return 30;
+    return 0;
+}
@@ -9,15 +9,28 @@
 
 #include "compiler.h"
 
+#ifndef CONFIG_HOSTED
 static struct node node_table[NUM_NODES];
+#endif
 static struct node *nodes;
 
+#ifdef CONFIG_HOSTED
+unsigned long nodes_made;	/* For the driver statistics */
+#endif
+
 struct node *new_node(void)
 {
 	register struct node *n;
+#ifdef CONFIG_HOSTED
+	nodes_made++;
+#endif
 	if (nodes == NULL) {
+#ifdef CONFIG_HOSTED
+		init_nodes();
+#else
 		error("too complex");
 		exit(1);
+#endif
 	}
 	n = nodes;
 	nodes = n->right;
@@ -35,10 +48,16 @@ void free_node(struct node *n)
 	nodes = n;
 }
 
+/* On a hosted build this is also used to add another block of nodes to
+   the free list when we run out */
 void init_nodes(void)
 {
 	register int i;
+#ifdef CONFIG_HOSTED
+	register struct node *n = pool_get(NUM_NODES * sizeof(struct node));
+#else
 	register struct node *n = node_table;
+#endif
 	for (i = 0; i < NUM_NODES; i++)
 		free_node(n++);
 }
@@ -258,8 +277,31 @@ void free_tree(register struct node *n)
 	free_node(n);
 }
 
-static void write_subtree(register struct node *n)
+/* A local or argument that is loaded, assigned or updated as a simple
+   variable. Anything else may be taking its address */
+static unsigned local_direct(register struct node *p, register struct node *n)
+{
+	register unsigned op;
+
+	if (p == NULL || !(n->flags & LVAL) || IS_ARRAY(n->type))
+		return 0;
+	if (!IS_SIMPLE(n->type) && !PTR(n->type))
+		return 0;
+	op = p->op;
+	if (op == T_DEREF)
+		return 1;
+	if (n != p->left)
+		return 0;
+	return op == T_EQ || op == T_PLUSPLUS || op == T_MINUSMINUS ||
+		op == T_PLUSEQ || op == T_MINUSEQ || op == T_STAREQ ||
+		op == T_SLASHEQ || op == T_PERCENTEQ || op == T_SHLEQ ||
+		op == T_SHREQ || op == T_ANDEQ || op == T_HATEQ || op == T_OREQ;
+}
+
+static void write_subtree(register struct node *n, struct node *p)
 {
+	if ((n->op == T_LOCAL || n->op == T_ARGUMENT) && !local_direct(p, n))
+		func_flags &= ~F_NOADDR;
 	/* Replace the array code with the simple type info of the
 	   node for the backend, otherwise some backends cannot work
 	   out how to access the object (Think word addressing/bytepointers) */
@@ -268,16 +310,16 @@ static void write_subtree(register struct node *n)
 	}
 	out_block(n, sizeof(struct node));
 	if (n->left)
-		write_subtree(n->left);
+		write_subtree(n->left, n);
 	if (n->right)
-		write_subtree(n->right);
+		write_subtree(n->right, n);
 	free_node(n);
 }
 
 void write_tree(struct node *n)
 {
 	out_block("%^", 2);
-	write_subtree(n);
+	write_subtree(n, NULL);
 }
 
 void write_null_tree(void)
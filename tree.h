@@ -24,6 +24,9 @@ extern struct node *typed_tree(unsigned op, unsigned type, struct node *l, struc
 extern struct node *tree(unsigned op, struct node *l, struct node *r);
 extern struct node *sf_tree(unsigned op, struct node *l, struct node *r);
 extern void free_node(struct node *n);
+#ifdef CONFIG_HOSTED
+extern unsigned long nodes_made;
+#endif
 extern struct node *new_node(void);
 
 extern struct node *make_rval(struct node *n);